@@ -0,0 +1,1177 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "augmented_list.hpp"
+#include "compressed_int_list.hpp"
+#include "list.hpp"
+#include "list_format.hpp"
+#include "lru_cache.hpp"
+#include "rcu_list.hpp"
+#include "reclaimer.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using BenchmarkFunction = void (*)();
+
+struct BenchmarkFunctionWithName {
+  BenchmarkFunction function;
+  std::string       name;
+};
+
+std::vector<BenchmarkFunctionWithName> benchmarkFunctions{};
+
+#define BENCHMARK(benchmarkName)                                     \
+  void benchmarkName();                                              \
+  struct benchmarkName##Struct {                                     \
+    benchmarkName##Struct()                                          \
+    {                                                                \
+      benchmarkFunctions.push_back(                                  \
+        BenchmarkFunctionWithName{&benchmarkName, #benchmarkName});  \
+    }                                                                \
+  } benchmarkName##StructInstance{};                                 \
+  void benchmarkName()
+
+// Number of elements the benchmarks operate on, set with --elements=N.
+std::size_t elementCount{1'000'000};
+
+// Results of measured code are added to this so that it can't be optimized
+// away.
+volatile std::size_t sink{0};
+
+constexpr int repetitions{5};
+
+#ifdef __linux__
+// A hardware or kernel event that perf_event_open(2) can count.
+struct PerfEvent {
+  const char*   name;
+  std::uint32_t type;
+  std::uint64_t config;
+};
+
+constexpr std::uint64_t cacheEvent(
+  std::uint64_t cache,
+  std::uint64_t operation,
+  std::uint64_t result)
+{
+  return cache | (operation << 8) | (result << 16);
+}
+
+constexpr std::array<PerfEvent, 7> perfEvents{{
+  {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {"L1D misses",
+   PERF_TYPE_HW_CACHE,
+   cacheEvent(
+     PERF_COUNT_HW_CACHE_L1D,
+     PERF_COUNT_HW_CACHE_OP_READ,
+     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"LLC misses",
+   PERF_TYPE_HW_CACHE,
+   cacheEvent(
+     PERF_COUNT_HW_CACHE_LL,
+     PERF_COUNT_HW_CACHE_OP_READ,
+     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"dTLB misses",
+   PERF_TYPE_HW_CACHE,
+   cacheEvent(
+     PERF_COUNT_HW_CACHE_DTLB,
+     PERF_COUNT_HW_CACHE_OP_READ,
+     PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  {"page faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+}};
+
+using PerfCounts = std::array<std::optional<double>, perfEvents.size()>;
+
+// Counts perfEvents in user space for the thread that created it.
+// Events that can't be counted, e.g. because the machine is virtual or
+// perf_event_paranoid forbids it, are left out; the counts of those that
+// the kernel had to multiplex are scaled up to the whole measurement.
+class PerfCounters {
+public:
+  PerfCounters() : m_fds{}
+  {
+    for (std::size_t i{0}; i < perfEvents.size(); ++i) {
+      perf_event_attr attributes{};
+      attributes.size           = sizeof(attributes);
+      attributes.type           = perfEvents[i].type;
+      attributes.config         = perfEvents[i].config;
+      attributes.disabled       = 1;
+      attributes.exclude_kernel = 1;
+      attributes.exclude_hv     = 1;
+      attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED
+                               | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      m_fds[i] = static_cast<int>(
+        ::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters()
+  {
+    for (int fd : m_fds) {
+      if (fd != -1) { ::close(fd); }
+    }
+  }
+
+  // Whether perfEvents[event] can be counted.
+  bool counts(std::size_t event) const { return m_fds[event] != -1; }
+
+  // Whether any event can be counted.
+  bool available() const
+  {
+    return std::any_of(
+      m_fds.begin(), m_fds.end(), [](int fd) { return fd != -1; });
+  }
+
+  void start()
+  {
+    for (int fd : m_fds) {
+      if (fd != -1) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  }
+
+  void stop()
+  {
+    for (int fd : m_fds) {
+      if (fd != -1) { ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); }
+    }
+  }
+
+  // The counts since the last start.
+  PerfCounts read() const
+  {
+    PerfCounts counts{};
+
+    for (std::size_t i{0}; i < perfEvents.size(); ++i) {
+      // value, time enabled, time running
+      std::uint64_t values[3]{};
+
+      if (
+        m_fds[i] == -1
+        || ::read(m_fds[i], values, sizeof(values)) != sizeof(values)
+        || values[2] == 0) {
+        continue;
+      }
+
+      counts[i] = static_cast<double>(values[0])
+                  * static_cast<double>(values[1])
+                  / static_cast<double>(values[2]);
+    }
+
+    return counts;
+  }
+
+private:
+  std::array<int, perfEvents.size()> m_fds;
+};
+#else
+struct PerfEvent {
+  const char* name;
+};
+
+// perf_event_open(2) only exists on Linux; elsewhere nothing is counted.
+constexpr std::array<PerfEvent, 0> perfEvents{};
+
+using PerfCounts = std::array<std::optional<double>, perfEvents.size()>;
+
+class PerfCounters {
+public:
+  bool counts(std::size_t) const { return false; }
+
+  bool available() const { return false; }
+
+  void start() {}
+
+  void stop() {}
+
+  PerfCounts read() const { return PerfCounts{}; }
+};
+#endif
+
+// Set to false with --no-counters.
+bool countersEnabled{true};
+
+PerfCounters& perfCounters()
+{
+  static PerfCounters counters{};
+  return counters;
+}
+
+// Prints the counts of the events that could be counted divided by
+// elements.
+void printPerfCounts(const PerfCounts& counts, std::size_t elements)
+{
+  std::string line{};
+
+  for (std::size_t i{0}; i < perfEvents.size(); ++i) {
+    if (!counts[i]) { continue; }
+
+    char text[64]{};
+    std::snprintf(
+      text,
+      sizeof(text),
+      "  %s %.3f",
+      perfEvents[i].name,
+      *counts[i] / static_cast<double>(std::max<std::size_t>(elements, 1)));
+    line += text;
+  }
+
+  if (!line.empty()) { std::printf("   %s per element\n", line.c_str()); }
+}
+
+// Runs callable repetitions times and prints the fastest run, followed by
+// the performance counts of that run if they are available.
+// setup is run before every repetition and is not measured.
+template<typename Setup, typename Callable>
+void measure(
+  std::string_view label,
+  std::size_t      elements,
+  Setup            setup,
+  Callable         callable)
+{
+  using Clock = std::chrono::steady_clock;
+
+  const bool      counting{countersEnabled && perfCounters().available()};
+  Clock::duration best{Clock::duration::max()};
+  PerfCounts      bestCounts{};
+
+  for (int i{0}; i < repetitions; ++i) {
+    std::invoke(setup);
+
+    if (counting) { perfCounters().start(); }
+
+    const Clock::time_point start{Clock::now()};
+    std::invoke(callable);
+    const Clock::duration elapsed{Clock::now() - start};
+
+    if (counting) { perfCounters().stop(); }
+
+    if (elapsed < best) {
+      best = elapsed;
+
+      if (counting) { bestCounts = perfCounters().read(); }
+    }
+  }
+
+  const double nanoseconds{
+    static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(best).count())};
+
+  std::printf(
+    "  %-44.*s %12.3f ms %10.2f ns/element\n",
+    static_cast<int>(label.size()),
+    label.data(),
+    nanoseconds / 1e6,
+    nanoseconds / static_cast<double>(std::max<std::size_t>(elements, 1)));
+
+  if (counting) { printPerfCounts(bestCounts, elements); }
+}
+
+template<typename Callable>
+void measure(std::string_view label, std::size_t elements, Callable callable)
+{
+  measure(label, elements, [] {}, callable);
+}
+
+template<typename Ty, typename Generator>
+List<Ty> makeList(std::size_t elements, Generator generator)
+{
+  List<Ty> list{};
+
+  for (std::size_t i{0}; i < elements; ++i) { list.push_back(generator(i)); }
+
+  return list;
+}
+
+template<typename Ty>
+void measureFormatting(const List<Ty>& list)
+{
+  measure("operator<< into std::ostringstream", list.size(), [&list] {
+    std::ostringstream oss{};
+    oss << list;
+    sink = sink + oss.str().size();
+  });
+
+  std::string buffer{};
+  measure("appendTo with a reused buffer", list.size(), [&list, &buffer] {
+    buffer.clear();
+    appendTo(buffer, list);
+    sink = sink + buffer.size();
+  });
+
+#ifdef __cpp_lib_format
+  measure("std::format", list.size(), [&list] {
+    sink = sink + std::format("{}", list).size();
+  });
+#endif
+}
+
+BENCHMARK(formatIntList)
+{
+  measureFormatting(makeList<int>(elementCount, [](std::size_t i) {
+    return static_cast<int>(i * 7919 % 1'000'003) - 500'000;
+  }));
+}
+
+BENCHMARK(formatDoubleList)
+{
+  measureFormatting(makeList<double>(elementCount, [](std::size_t i) {
+    return static_cast<double>(i) / 7.0;
+  }));
+}
+
+template<typename ListType>
+void measureCopyAndDestroy(std::string_view name)
+{
+  ListType list{};
+
+  for (std::size_t i{0}; i < elementCount; ++i) {
+    list.push_back(static_cast<int>(i));
+  }
+
+  ListType copy{};
+  measure(
+    "copy " + std::string{name},
+    elementCount,
+    [&copy] { copy.clear(); },
+    [&list, &copy] { copy = list; });
+
+  measure(
+    "destroy " + std::string{name},
+    elementCount,
+    [&list, &copy] { copy = list; },
+    [&copy] { copy.clear(); });
+
+  copy = list;
+  measure("compare equal " + std::string{name} + "s", elementCount, [&] {
+    sink = sink + (list == copy);
+  });
+}
+
+// glibc returns the slab that a destroyed copy frees to the kernel, so
+// every copy into a slab measured here page faults on fresh memory. Run
+// with GLIBC_TUNABLES=glibc.malloc.trim_threshold=4294967296 to measure
+// copies into reused memory instead.
+BENCHMARK(copyAndDestroy)
+{
+  measureCopyAndDestroy<List<int>>("List<int>");
+  measureCopyAndDestroy<List<int, ListConfig{.usesSlabs = true}>>(
+    "slab List<int>");
+}
+
+// How long tearing down a list blocks the calling thread.
+BENCHMARK(teardownLatency)
+{
+  const List<std::string> list{makeList<std::string>(
+    elementCount, [](std::size_t i) { return std::to_string(i); })};
+  List<std::string> copy{};
+
+  const auto setup{[&list, &copy] {
+    Reclaimer::instance().wait();
+    copy = list;
+  }};
+
+  measure("clear List<std::string>", elementCount, setup, [&copy] {
+    copy.clear();
+  });
+
+  measure("release_async List<std::string>", elementCount, setup, [&copy] {
+    copy.release_async();
+  });
+
+  std::chrono::steady_clock::duration longestCall{};
+  measure("clear_incremental(4096) List<std::string>", elementCount, setup,
+    [&copy, &longestCall] {
+      longestCall = {};
+
+      for (bool cleared{false}; !cleared;) {
+        const auto start{std::chrono::steady_clock::now()};
+        cleared = copy.clear_incremental(4096);
+        longestCall
+          = std::max(longestCall, std::chrono::steady_clock::now() - start);
+      }
+    });
+  std::printf(
+    "  longest clear_incremental(4096) call: %.3f ms\n",
+    std::chrono::duration<double, std::milli>{longestCall}.count());
+
+  Reclaimer::instance().wait();
+}
+
+// Relinks the nodes in a random order, as a lot of insertions and erasures
+// at random positions would.
+template<typename ListType>
+void scatter(ListType& list)
+{
+  std::vector<typename ListType::const_iterator> nodes{};
+  nodes.reserve(list.size());
+
+  for (auto it{list.cbegin()}; it != list.cend(); ++it) { nodes.push_back(it); }
+
+  std::shuffle(nodes.begin(), nodes.end(), std::mt19937_64{42});
+
+  for (const auto& it : nodes) { list.splice(list.cend(), list, it); }
+}
+
+BENCHMARK(defragmentation)
+{
+  List<std::int64_t, ListConfig{.usesSlabs = true}> list{};
+
+  for (std::size_t i{0}; i < elementCount; ++i) {
+    list.push_back(static_cast<std::int64_t>(i));
+  }
+
+  scatter(list);
+
+  const auto sum{[&list] {
+    sink = sink
+           + static_cast<std::size_t>(
+             std::accumulate(list.begin(), list.end(), std::int64_t{0}));
+  }};
+
+  measure("iterate a scattered List<int64_t>", elementCount, sum);
+
+  double fragmentation{0.0};
+  measure(
+    "defragment",
+    elementCount,
+    [&list] { scatter(list); },
+    [&list, &fragmentation] {
+      fragmentation = list.defragment().fragmentation();
+    });
+  std::printf("  fragmentation before defragmenting: %.3f\n", fragmentation);
+
+  measure("iterate the defragmented List<int64_t>", elementCount, sum);
+}
+
+template<std::size_t Bytes>
+struct Payload {
+  std::uint64_t               id;
+  std::array<char, Bytes - 8> bytes;
+};
+
+// Operations that only follow and rewrite the links of a scattered list of
+// Bytes large elements, which are stored in the nodes or out of line.
+template<std::size_t Bytes, std::size_t OutOfLineSize>
+void measureLinkOperations(std::string_view storage)
+{
+  // The link-only nodes of elements stored out of line are kept in slabs.
+  using ListType = List<
+    Payload<Bytes>,
+    ListConfig{
+      .usesSlabs = OutOfLineSize != 0, .outOfLineSize = OutOfLineSize}>;
+
+  // Keeps the payloads of the default 10 million elements within 256 MiB.
+  const std::size_t elements{
+    std::min(elementCount, (std::size_t{256} << 20) / Bytes)};
+  ListType list{};
+  ListType other{};
+
+  const auto refill{[&list, &other, elements] {
+    list.splice(list.end(), other);
+
+    while (list.size() < elements) {
+      list.push_back(Payload<Bytes>{list.size(), {}});
+    }
+  }};
+
+  refill();
+  scatter(list);
+
+  const std::string prefix{
+    std::to_string(Bytes) + " B " + std::string{storage}};
+
+  measure(prefix + ": std::distance", elements, [&list] {
+    sink = sink
+           + static_cast<std::size_t>(std::distance(list.begin(), list.end()));
+  });
+
+  measure(prefix + ": operator[] at 10 positions", elements * 5, [&list] {
+    for (std::size_t i{0}; i < 10; ++i) {
+      sink = sink + list[list.size() / 10 * i].id;
+    }
+  });
+
+  measure(prefix + ": splice every other element", elements, refill, [&] {
+    for (auto it{list.begin()}; it != list.end();) {
+      other.splice(other.end(), list, it++);
+
+      if (it != list.end()) { ++it; }
+    }
+  });
+
+  measure(prefix + ": erase every other element", elements, refill, [&list] {
+    for (auto it{list.begin()}; it != list.end();) {
+      it = list.erase(it);
+
+      if (it != list.end()) { ++it; }
+    }
+  });
+}
+
+BENCHMARK(outOfLineStorage)
+{
+  measureLinkOperations<256, 0>("inline");
+  measureLinkOperations<256, 256>("out of line");
+  measureLinkOperations<1024, 0>("inline");
+  measureLinkOperations<1024, 1024>("out of line");
+}
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+// Iterates over a list whose nodes are visited in a random order, which
+// takes a TLB miss per node once the list spans many more pages than the
+// TLB covers, e.g. --elements=30000000.
+BENCHMARK(hugePageArena)
+{
+  using SlabList = List<std::int64_t, ListConfig{.usesSlabs = true}>;
+
+  HugePageArena arena{};
+
+  const auto iterate{[](const char* label, SlabList& list) {
+    for (std::size_t i{0}; i < elementCount; ++i) {
+      list.push_back(static_cast<std::int64_t>(i));
+    }
+
+    scatter(list);
+    measure(label, elementCount, [&list] {
+      sink = sink
+             + static_cast<std::size_t>(
+               std::accumulate(list.begin(), list.end(), std::int64_t{0}));
+    });
+  }};
+
+  {
+    SlabList list{};
+    iterate("iterate with slabs from operator new", list);
+  }
+
+  SlabList list{arena};
+  iterate("iterate with slabs from a HugePageArena", list);
+  std::printf(
+    "  huge pages %s\n",
+    arena.uses_huge_pages() ? "requested" : "not available");
+}
+#endif
+
+// The number of bytes of resident memory of the process; 0 where there is
+// no /proc to read it from.
+std::size_t residentBytes()
+{
+#ifdef __linux__
+  std::ifstream statm{"/proc/self/statm"};
+  std::size_t   pages{0};
+  std::size_t   residentPages{0};
+  statm >> pages >> residentPages;
+  return residentPages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+// Mostly increasing 64 bit IDs with small gaps and an occasional jump.
+BENCHMARK(compressedIntList)
+{
+  const auto makeIds{[](auto& ids) {
+    std::mt19937_64 engine{42};
+    std::int64_t    id{1'000'000'000'000};
+
+    for (std::size_t i{0}; i < elementCount; ++i) {
+      id += engine() % 1000 == 0 ? static_cast<std::int64_t>(engine() >> 40)
+                                 : static_cast<std::int64_t>(engine() % 16);
+      ids.push_back(id);
+    }
+  }};
+
+  const auto report{[](const char* label, std::size_t bytes) {
+    std::printf(
+      "  %-44s %12.1f MiB %10.2f bytes/element\n",
+      label,
+      static_cast<double>(bytes) / (1 << 20),
+      static_cast<double>(bytes)
+        / static_cast<double>(std::max<std::size_t>(elementCount, 1)));
+  }};
+
+  std::size_t        before{residentBytes()};
+  List<std::int64_t> list{};
+  makeIds(list);
+  report("List<int64_t> resident memory", residentBytes() - before);
+
+  before = residentBytes();
+  CompressedIntList<> compressed{};
+  makeIds(compressed);
+  report("CompressedIntList resident memory", residentBytes() - before);
+
+  measure("iterate List<int64_t>", elementCount, [&list] {
+    sink = sink
+           + static_cast<std::size_t>(
+             std::accumulate(list.begin(), list.end(), std::int64_t{0}));
+  });
+
+  measure("iterate CompressedIntList", elementCount, [&compressed] {
+    sink = sink
+           + static_cast<std::size_t>(std::accumulate(
+             compressed.begin(), compressed.end(), std::int64_t{0}));
+  });
+
+  std::vector<std::int64_t> decoded(elementCount);
+  measure("CompressedIntList::decode", elementCount, [&] {
+    compressed.decode(decoded.begin());
+    sink = sink + static_cast<std::size_t>(decoded.back());
+  });
+}
+
+// A record with a payload, the nodes of which are sorted by one of its keys.
+struct Record {
+  std::uint64_t id;
+  std::string   name;
+  double        payload[4];
+};
+
+BENCHMARK(sortByKey)
+{
+  std::mt19937_64    engine{42};
+  const List<Record> original{makeList<Record>(elementCount, [&](std::size_t) {
+    const std::uint64_t id{engine()};
+    return Record{id, "record-" + std::to_string(id % 1'000'000'007), {}};
+  })};
+  List<Record> list{};
+  const auto   reset{[&original, &list] { list = original; }};
+  const auto   check{[&list] { sink = sink + list.front().id; }};
+
+  measure("sort with a comparator on an integer key", elementCount, reset, [&] {
+    list.sort([](const Record& lhs, const Record& rhs) {
+      return lhs.id < rhs.id;
+    });
+    check();
+  });
+
+  measure("sort_by_key on an integer key (radix)", elementCount, reset, [&] {
+    list.sort_by_key([](const Record& record) { return record.id; });
+    check();
+  });
+
+  // A key that is costly to compute, which the comparator computes twice per
+  // comparison.
+  const auto upperCaseName{[](const Record& record) {
+    std::string name{record.name};
+
+    for (char& c : name) {
+      if (c >= 'a' && c <= 'z') { c = static_cast<char>(c - 'a' + 'A'); }
+    }
+
+    return name;
+  }};
+
+  measure("sort with a comparator on a computed key", elementCount, reset, [&] {
+    list.sort([&upperCaseName](const Record& lhs, const Record& rhs) {
+      return upperCaseName(lhs) < upperCaseName(rhs);
+    });
+    check();
+  });
+
+  measure("sort_by_key on a computed key (cached)", elementCount, reset, [&] {
+    list.sort_by_key(upperCaseName);
+    check();
+  });
+}
+
+// Merges a sorted batch of 1000 new IDs into a sorted list of a tenth of
+// elementCount IDs, and applies 1000 insertions and erasures at random
+// positions.
+BENCHMARK(batchedUpdates)
+{
+  constexpr std::size_t batchSize{1000};
+  const std::size_t     elements{std::max<std::size_t>(elementCount / 10, 1)};
+  std::mt19937_64       engine{42};
+
+  std::vector<std::uint64_t> ids(elements);
+  std::generate(ids.begin(), ids.end(), [&engine] { return engine(); });
+  std::ranges::sort(ids);
+  std::vector<std::uint64_t> batch(batchSize);
+  std::generate(batch.begin(), batch.end(), [&engine] { return engine(); });
+  std::ranges::sort(batch);
+
+  const List<std::uint64_t> original(from_range, ids);
+  List<std::uint64_t>       list{};
+  const auto                reset{[&original, &list] { list = original; }};
+
+  measure("search and insert one at a time", elements, reset, [&] {
+    for (std::uint64_t id : batch) {
+      list.insert(
+        std::find_if(
+          list.begin(), list.end(), [id](std::uint64_t e) { return e > id; }),
+        id);
+    }
+  });
+
+  measure("insert_batch_sorted", elements, reset, [&] {
+    list.insert_batch_sorted(batch);
+  });
+
+  using Position = List<std::uint64_t>::const_iterator;
+  std::vector<std::pair<Position, std::uint64_t>> insertions{};
+  std::vector<Position>                           erasures{};
+
+  // Picks distinct positions to erase and arbitrary ones to insert at.
+  const auto pickPositions{[&] {
+    reset();
+    std::vector<Position> positions{};
+
+    for (auto it{list.cbegin()}; it != list.cend(); ++it) {
+      positions.push_back(it);
+    }
+
+    std::shuffle(positions.begin(), positions.end(), engine);
+    positions.resize(std::min(2 * batchSize, positions.size()));
+    insertions.clear();
+    erasures.assign(positions.begin() + positions.size() / 2, positions.end());
+
+    for (std::size_t i{0}; i < positions.size() / 2; ++i) {
+      insertions.emplace_back(positions[i], batch[i]);
+    }
+  }};
+
+  measure("insert and erase one at a time", batchSize, pickPositions, [&] {
+    for (const auto& [pos, value] : insertions) { list.insert(pos, value); }
+
+    for (Position pos : erasures) { list.erase(pos); }
+  });
+
+  measure("apply_batch", batchSize, pickPositions, [&] {
+    list.apply_batch(insertions, erasures);
+  });
+}
+
+// Queries the sum and the maximum of elementCount values after every one of
+// 100 small changes, and compares lists that only differ in their last
+// element.
+BENCHMARK(augmentedList)
+{
+  constexpr int changes{100};
+
+  using Augmented = AugmentedList<
+    std::int64_t,
+    SumMonoid<std::int64_t>,
+    MaxMonoid<std::int64_t>>;
+
+  List<std::int64_t> list{};
+  Augmented          augmented{};
+
+  for (std::size_t i{0}; i < elementCount; ++i) {
+    list.push_back(static_cast<std::int64_t>(i % 1000));
+    augmented.push_back(static_cast<std::int64_t>(i % 1000));
+  }
+
+  measure("List: change, then sum and max", elementCount * changes, [&] {
+    for (int i{0}; i < changes; ++i) {
+      list.push_back(list.front());
+      list.pop_front();
+      sink = sink
+             + static_cast<std::size_t>(
+               std::accumulate(list.begin(), list.end(), std::int64_t{0}))
+             + static_cast<std::size_t>(
+               *std::max_element(list.begin(), list.end()));
+    }
+  });
+
+  measure(
+    "AugmentedList: change, then aggregate<>", elementCount * changes, [&] {
+      for (int i{0}; i < changes; ++i) {
+        augmented.push_back(augmented.front());
+        augmented.pop_front();
+        sink = sink
+               + static_cast<std::size_t>(
+                 augmented.aggregate<SumMonoid<std::int64_t>>())
+               + static_cast<std::size_t>(
+                 augmented.aggregate<MaxMonoid<std::int64_t>>());
+      }
+    });
+
+  List<std::int64_t> otherList{list};
+  Augmented          otherAugmented{augmented};
+  otherList.back() += 1;
+  otherAugmented.pop_back();
+  otherAugmented.push_back(list.back() + 1);
+
+  measure("List: operator== of unequal lists", elementCount, [&] {
+    sink = sink + static_cast<std::size_t>(list == otherList);
+  });
+
+  measure("AugmentedList: operator== of unequal lists", elementCount, [&] {
+    sink = sink + static_cast<std::size_t>(augmented == otherAugmented);
+  });
+}
+
+// Finds the 100 largest of elementCount random scores, as for a leaderboard.
+BENCHMARK(topK)
+{
+  constexpr std::size_t     k{100};
+  std::mt19937_64           engine{42};
+  const List<std::uint64_t> original{makeList<std::uint64_t>(
+    elementCount, [&engine](std::size_t) { return engine(); })};
+  List<std::uint64_t> list{};
+  const auto          reset{[&original, &list] { list = original; }};
+  const auto          greater{std::greater<std::uint64_t>{}};
+
+  measure("sort, then take the top 100", elementCount, reset, [&] {
+    list.sort(greater);
+    sink = sink + *std::next(list.begin(), k - 1);
+  });
+
+  measure("partial_sort(100)", elementCount, reset, [&] {
+    sink = sink + *std::prev(list.partial_sort(k, greater));
+  });
+
+  measure("nth_element(99)", elementCount, reset, [&] {
+    sink = sink + *list.nth_element(k - 1, greater);
+  });
+}
+
+// Builds a list of elementCount IDs from a std::vector, as when loading a
+// table, serially and on an increasing number of threads.
+BENCHMARK(parallelConstruction)
+{
+  std::vector<std::int64_t> ids(elementCount);
+  std::iota(ids.begin(), ids.end(), std::int64_t{0});
+  List<std::int64_t> list{};
+  const auto         reset{[&list] { list.clear(); }};
+
+  measure("push_back of every element", elementCount, reset, [&] {
+    for (std::int64_t id : ids) { list.push_back(id); }
+
+    sink = sink + list.size();
+  });
+
+  const unsigned hardwareThreads{
+    std::max(std::thread::hardware_concurrency(), 1U)};
+
+  for (unsigned threads{1}; threads <= hardwareThreads; threads *= 2) {
+    const std::string label{
+      "assign(parallel, ...) on " + std::to_string(threads) + " thread(s)"};
+
+    measure(label, elementCount, reset, [&] {
+      list.assign(parallel, ids.begin(), ids.end(), threads);
+      sink = sink + list.size();
+    });
+  }
+}
+
+// A producer thread builds batches of elements that it hands over to a
+// consumer thread, which erases them one by one.
+template<typename ListType>
+void measureHandoff(std::string_view label)
+{
+  using Chain = typename ListType::node_chain;
+
+  constexpr std::size_t batchSize{256};
+  constexpr std::size_t maxQueuedChains{16};
+
+  measure(label, elementCount, [] {
+    std::mutex              mutex{};
+    std::condition_variable changed{};
+    std::deque<Chain>       chains{};
+
+    std::thread consumer{[&] {
+      ListType    list{};
+      std::size_t consumed{0};
+
+      while (true) {
+        std::unique_lock<std::mutex> lock{mutex};
+        changed.wait(lock, [&chains] { return !chains.empty(); });
+        Chain chain{std::move(chains.front())};
+        chains.pop_front();
+        lock.unlock();
+        changed.notify_one();
+
+        if (chain.empty()) { break; }
+
+        list.adopt_chain(list.end(), std::move(chain));
+
+        while (!list.empty()) {
+          consumed += list.front().size();
+          list.pop_front();
+        }
+      }
+
+      sink = sink + consumed;
+    }};
+
+    ListType batch{};
+
+    for (std::size_t i{0}; i < elementCount; i += batchSize) {
+      for (std::size_t j{i}; j < std::min(i + batchSize, elementCount); ++j) {
+        batch.push_back(std::to_string(j));
+      }
+
+      std::unique_lock<std::mutex> lock{mutex};
+      changed.wait(
+        lock, [&chains] { return chains.size() < maxQueuedChains; });
+      chains.push_back(batch.detach_chain());
+      lock.unlock();
+      changed.notify_one();
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock{mutex};
+      chains.emplace_back();
+    }
+
+    changed.notify_one();
+    consumer.join();
+  });
+}
+
+BENCHMARK(crossThreadHandoff)
+{
+  measureHandoff<List<std::string>>("nodes from operator new");
+  measureHandoff<List<std::string, ListConfig{.cachesNodes = true}>>(
+    "nodes from a NodeCache");
+}
+
+// Looks up elementCount keys, most of which are cached, and caches the
+// missing ones.
+// The variant that runs second finds the allocator's free lists shuffled by
+// the first one, so its nodes and their index entries end up scattered.
+// LruCache never moves its nodes and suffers more from that: with
+// --elements=10000000 it turns from ~40% faster into ~35% slower when it is
+// measured second.
+BENCHMARK(lruCacheLookups)
+{
+  const std::size_t capacity{std::max<std::size_t>(elementCount / 100, 1)};
+  const std::size_t keyCount{capacity + capacity / 8 + 1};
+  // Uniformly distributed keys; a cyclic pattern would never hit in an LRU
+  // cache that is smaller than the key space.
+  const auto key{[keyCount](std::size_t i) {
+    std::uint64_t x{i + 0x9e3779b97f4a7c15};
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return static_cast<std::size_t>((x ^ (x >> 31)) % keyCount);
+  }};
+
+  measure("LruCache", elementCount, [&] {
+    LruCache<std::size_t, std::size_t> cache{capacity};
+
+    for (std::size_t i{0}; i < elementCount; ++i) {
+      const std::size_t currentKey{key(i)};
+
+      if (const std::size_t* value{cache.find(currentKey)}) {
+        sink = sink + *value;
+      }
+      else {
+        cache.put(currentKey, currentKey);
+        sink = sink + currentKey;
+      }
+    }
+  });
+
+  measure("List + std::unordered_map, erase and push_front", elementCount, [&] {
+    using Entry = std::pair<std::size_t, std::size_t>;
+
+    List<Entry> entries{};
+    std::unordered_map<std::size_t, List<Entry>::iterator> index{};
+
+    for (std::size_t i{0}; i < elementCount; ++i) {
+      const std::size_t currentKey{key(i)};
+      const auto        indexIt{index.find(currentKey)};
+      std::size_t       value{currentKey};
+
+      if (indexIt != index.end()) {
+        value = (*indexIt->second).second;
+        entries.erase(indexIt->second);
+      }
+      else if (entries.size() == capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+      }
+
+      entries.push_front(Entry{currentKey, value});
+      index.insert_or_assign(currentKey, entries.begin());
+      sink = sink + value;
+    }
+  });
+}
+
+// Runs readerCount threads that each traverse the list traversals times
+// while writerStep is run in a loop on another thread.
+template<typename Traverse, typename WriterStep>
+void measureReaders(
+  std::string_view label,
+  std::size_t      readerCount,
+  std::size_t      listSize,
+  Traverse         traverse,
+  WriterStep       writerStep)
+{
+  constexpr std::size_t traversals{20};
+
+  measure(label, readerCount * traversals * listSize, [&] {
+    std::atomic<bool>        stop{false};
+    std::thread              writer{[&stop, &writerStep] {
+      while (!stop.load()) { writerStep(); }
+    }};
+    std::vector<std::thread> readers{};
+
+    for (std::size_t i{0}; i < readerCount; ++i) {
+      readers.emplace_back([&traverse] {
+        for (std::size_t j{0}; j < traversals; ++j) { traverse(); }
+      });
+    }
+
+    for (std::thread& reader : readers) { reader.join(); }
+
+    stop.store(true);
+    writer.join();
+  });
+}
+
+BENCHMARK(readerScaling)
+{
+  const std::size_t listSize{std::max<std::size_t>(elementCount / 10, 1)};
+
+  for (std::size_t readerCount : {1, 2, 4, 8}) {
+    const std::string readers{std::to_string(readerCount) + " readers"};
+
+    {
+      RcuList<std::size_t> list{};
+
+      for (std::size_t i{0}; i < listSize; ++i) { list.push_back(i); }
+
+      std::size_t nextValue{listSize};
+
+      measureReaders(
+        "RcuList, " + readers,
+        readerCount,
+        listSize,
+        [&list] {
+          RcuList<std::size_t>::Reader reader{list};
+          auto                         guard{reader.lock()};
+          std::size_t                  sum{0};
+
+          for (std::size_t element : guard) { sum += element; }
+
+          sink = sink + sum;
+        },
+        [&list, &nextValue] {
+          list.pop_front();
+          list.push_back(nextValue++);
+        });
+
+      list.synchronize();
+    }
+
+    {
+      List<std::size_t> list{};
+      std::shared_mutex mutex{};
+
+      for (std::size_t i{0}; i < listSize; ++i) { list.push_back(i); }
+
+      std::size_t nextValue{listSize};
+
+      measureReaders(
+        "List with std::shared_mutex, " + readers,
+        readerCount,
+        listSize,
+        [&list, &mutex] {
+          const std::shared_lock<std::shared_mutex> lock{mutex};
+          std::size_t                               sum{0};
+
+          for (std::size_t element : list) { sum += element; }
+
+          sink = sink + sum;
+        },
+        [&list, &mutex, &nextValue] {
+          const std::unique_lock<std::shared_mutex> lock{mutex};
+          list.pop_front();
+          list.push_back(nextValue++);
+        });
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  using namespace std::string_view_literals;
+
+  std::string_view filter{};
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view argument{argv[i]};
+    constexpr std::string_view elementsOption{"--elements="};
+
+    if (argument.substr(0, elementsOption.size()) == elementsOption) {
+      elementCount = std::strtoull(
+        argv[i] + elementsOption.size(), nullptr, 10);
+    }
+    else if (argument == "--no-counters"sv) {
+      countersEnabled = false;
+    }
+    else {
+      filter = argument;
+    }
+  }
+
+  std::cout << "Running benchmarks with " << elementCount << " elements.\n";
+
+  if (countersEnabled && !perfCounters().available()) {
+    std::cout << "Performance counters aren't available, reporting times "
+                 "only.\n";
+  }
+  else if (countersEnabled) {
+    std::string missing{};
+
+    for (std::size_t i{0}; i < perfEvents.size(); ++i) {
+      if (!perfCounters().counts(i)) {
+        missing += missing.empty() ? "" : ", ";
+        missing += perfEvents[i].name;
+      }
+    }
+
+    if (!missing.empty()) {
+      std::cout << "Can't count " << missing << " on this machine.\n";
+    }
+  }
+
+  for (const auto& [func, name] : benchmarkFunctions) {
+    if (name.find(filter) == std::string::npos) { continue; }
+
+    std::cout << name << ":\n";
+    func();
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,32 @@
+# Compiles SOURCE to assembly with optimizations and fails if any of the
+# FUNCTIONS (a list of unmangled names) contains a jump or a call.
+# Only understands the x86-64 output of GCC and Clang.
+execute_process(
+  COMMAND
+    ${COMPILER} -std=c++20 -O2 -DNDEBUG -DLIST_NO_ALLOCATION_TRACKING
+    -I${INCLUDE_DIR} -S -o ${OUTPUT} ${SOURCE}
+  RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling ${SOURCE} failed.")
+endif()
+
+file(READ ${OUTPUT} assembly)
+
+foreach(function IN LISTS FUNCTIONS)
+  string(FIND "${assembly}" "\n${function}:" begin)
+
+  if(begin EQUAL -1)
+    message(FATAL_ERROR "${function} not found in ${OUTPUT}.")
+  endif()
+
+  string(SUBSTRING "${assembly}" ${begin} -1 body)
+  string(FIND "${body}" ".cfi_endproc" end)
+  string(SUBSTRING "${body}" 0 ${end} body)
+
+  if(body MATCHES "\n[ \t]+(j[a-z]+|call)[ \t]")
+    message(FATAL_ERROR "${function} contains a branch:${body}")
+  endif()
+
+  message(STATUS "${function} has no branches.")
+endforeach()
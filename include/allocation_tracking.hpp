@@ -0,0 +1,32 @@
+#ifndef INCG_ALLOCATION_TRACKING_HPP
+#define INCG_ALLOCATION_TRACKING_HPP
+#include <type_traits>
+
+// The test suite records every node allocation and deallocation to detect
+// leaks; it defines the functions below, which may be called from any
+// thread.
+// Define LIST_NO_ALLOCATION_TRACKING to build the containers without that
+// bookkeeping, e.g. for benchmarks.
+#ifndef LIST_NO_ALLOCATION_TRACKING
+void recordAllocation(void* pointer);
+
+void recordDeallocation(void* pointer);
+#endif
+
+// Allocations made during constant evaluation can't be recorded at run
+// time and don't need to be: the compiler rejects any of them that
+// would leak.
+constexpr void trackAllocation([[maybe_unused]] void* pointer)
+{
+#ifndef LIST_NO_ALLOCATION_TRACKING
+  if (!std::is_constant_evaluated()) { recordAllocation(pointer); }
+#endif
+}
+
+constexpr void trackDeallocation([[maybe_unused]] void* pointer)
+{
+#ifndef LIST_NO_ALLOCATION_TRACKING
+  if (!std::is_constant_evaluated()) { recordDeallocation(pointer); }
+#endif
+}
+#endif // INCG_ALLOCATION_TRACKING_HPP
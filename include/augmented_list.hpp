@@ -0,0 +1,567 @@
+#ifndef INCG_AUGMENTED_LIST_HPP
+#define INCG_AUGMENTED_LIST_HPP
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <concepts>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "list.hpp"
+
+// A monoid that AugmentedList can maintain over its elements of type Ty:
+// lift maps an element to a monoid value, combine is associative and
+// identity is its neutral element. The aggregate of a list is the combination
+// of the lifted elements in list order.
+// A monoid may also declare
+//   static value_type inverse(const value_type&), making it invertible,
+//   static constexpr bool commutative{true} and
+//   static constexpr bool selective{true} if combine always returns one of
+//   its arguments, e.g. min and max,
+// which let AugmentedList update its aggregate in more cases instead of
+// recomputing it; see AugmentedList.
+template<typename Monoid, typename Ty>
+concept ListMonoid = requires(
+  const Ty&                          element,
+  const typename Monoid::value_type& value) {
+  { Monoid::identity() } -> std::convertible_to<typename Monoid::value_type>;
+  { Monoid::lift(element) } -> std::convertible_to<typename Monoid::value_type>;
+  {
+    Monoid::combine(value, value)
+  } -> std::convertible_to<typename Monoid::value_type>;
+};
+
+template<typename Monoid>
+concept InvertibleMonoid
+  = requires(const typename Monoid::value_type& value) {
+      {
+        Monoid::inverse(value)
+      } -> std::convertible_to<typename Monoid::value_type>;
+    };
+
+template<typename Monoid>
+concept CommutativeMonoid = Monoid::commutative;
+
+template<typename Monoid>
+concept SelectiveMonoid
+  = Monoid::selective
+    && std::equality_comparable<typename Monoid::value_type>;
+
+// Floating point sums drift as elements are subtracted again.
+template<typename Ty>
+struct SumMonoid {
+  using value_type = Ty;
+
+  static constexpr bool commutative{true};
+
+  static constexpr value_type identity() { return value_type{}; }
+
+  static constexpr value_type lift(const Ty& element) { return element; }
+
+  static constexpr value_type combine(
+    const value_type& lhs,
+    const value_type& rhs)
+  {
+    return lhs + rhs;
+  }
+
+  static constexpr value_type inverse(const value_type& value)
+  {
+    return -value;
+  }
+};
+
+// The identity, i.e. the minimum of an empty list, is the largest Ty.
+template<typename Ty>
+struct MinMonoid {
+  using value_type = Ty;
+
+  static constexpr bool commutative{true};
+  static constexpr bool selective{true};
+
+  static constexpr value_type identity()
+  {
+    return std::numeric_limits<Ty>::max();
+  }
+
+  static constexpr value_type lift(const Ty& element) { return element; }
+
+  static constexpr value_type combine(
+    const value_type& lhs,
+    const value_type& rhs)
+  {
+    return rhs < lhs ? rhs : lhs;
+  }
+};
+
+// The identity, i.e. the maximum of an empty list, is the lowest Ty.
+template<typename Ty>
+struct MaxMonoid {
+  using value_type = Ty;
+
+  static constexpr bool commutative{true};
+  static constexpr bool selective{true};
+
+  static constexpr value_type identity()
+  {
+    return std::numeric_limits<Ty>::lowest();
+  }
+
+  static constexpr value_type lift(const Ty& element) { return element; }
+
+  static constexpr value_type combine(
+    const value_type& lhs,
+    const value_type& rhs)
+  {
+    return lhs < rhs ? rhs : lhs;
+  }
+};
+
+// A polynomial hash of the hashes of the elements, h(x1)·B^(n-1) + ... +
+// h(xn) modulo 2^64, which depends on the order of the elements.
+// The powers of the odd base B are invertible modulo 2^64, so elements can
+// be removed from either end again.
+template<typename Ty, typename Hash = std::hash<Ty>>
+struct HashMonoid {
+  struct value_type {
+    std::uint64_t hash;
+    std::uint64_t power;
+
+    friend constexpr bool operator==(const value_type&, const value_type&)
+      = default;
+  };
+
+  static constexpr std::uint64_t base{0x9E37'79B9'7F4A'7C15};
+
+  static constexpr value_type identity() { return value_type{0, 1}; }
+
+  static value_type lift(const Ty& element)
+  {
+    // Spreads the bits of hashes like std::hash<int>'s identity.
+    std::uint64_t hash{static_cast<std::uint64_t>(Hash{}(element))};
+    hash = (hash ^ (hash >> 30)) * 0xBF58'476D'1CE4'E5B9;
+    hash = (hash ^ (hash >> 27)) * 0x94D0'49BB'1331'11EB;
+    return value_type{hash ^ (hash >> 31), base};
+  }
+
+  static constexpr value_type combine(
+    const value_type& lhs,
+    const value_type& rhs)
+  {
+    return value_type{lhs.hash * rhs.power + rhs.hash, lhs.power * rhs.power};
+  }
+
+  static constexpr value_type inverse(const value_type& value)
+  {
+    // Newton's iteration doubles the number of correct low bits, starting
+    // with 3 for any odd number.
+    std::uint64_t inversePower{value.power};
+
+    for (int i{0}; i < 5; ++i) {
+      inversePower *= 2 - value.power * inversePower;
+    }
+
+    return value_type{0 - value.hash * inversePower, inversePower};
+  }
+};
+
+// A List that maintains the aggregates of its elements for each of
+// Monoids, see ListMonoid, so that e.g. their sum doesn't take a traversal
+// every time it is needed, as well as a hash of its elements if they can be
+// hashed with std::hash, so that operator== rejects most lists of the same
+// size that differ in O(1).
+// Adding an element at either end updates an aggregate in O(1), inserting
+// one elsewhere only if the monoid is commutative. Removing an element from
+// either end takes an invertible monoid, removing one elsewhere an
+// invertible and commutative one; a selective and commutative monoid
+// only needs to be recomputed if the removed element was its aggregate.
+// Otherwise the aggregate is recomputed in O(n) when it is queried next.
+// Recomputing happens under a mutex, so that const member functions can
+// be called from several threads at once like those of a List; reading an
+// aggregate that is up to date takes no lock.
+// Elements can't be modified through iterators, as that would bypass the
+// aggregates.
+template<typename Ty, typename... Monoids>
+  requires(ListMonoid<Monoids, Ty> && ...)
+class AugmentedList {
+public:
+  using value_type      = Ty;
+  using this_type       = AugmentedList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = const value_type&;
+  using const_reference = const value_type&;
+
+private:
+  using Elements = List<value_type>;
+
+  template<typename Monoid>
+  struct Aggregate {
+    typename Monoid::value_type value{Monoid::identity()};
+    bool                        stale{false};
+  };
+
+  struct NoAggregate {
+  };
+
+  static constexpr bool hashesElements{
+    requires(const value_type& element) { std::hash<value_type>{}(element); }};
+
+  using Hash = std::conditional_t<
+    hashesElements,
+    Aggregate<HashMonoid<value_type>>,
+    NoAggregate>;
+
+  // Where an element was added or removed.
+  enum class Position { front, back, middle };
+
+public:
+  using const_iterator         = typename Elements::const_iterator;
+  using iterator               = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator       = const_reverse_iterator;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "AugmentedList[]"; }
+
+    os << "AugmentedList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  // Compares the hashes first, if the elements are hashed; they may have to
+  // be recomputed, see AugmentedList.
+  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  {
+    if (lhs.size() != rhs.size()) { return false; }
+
+    if constexpr (hashesElements) {
+      if (!(lhs.hash() == rhs.hash())) { return false; }
+    }
+
+    return lhs.m_elements == rhs.m_elements;
+  }
+
+  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  AugmentedList()
+    : m_elements{}, m_aggregates{}, m_hash{}, m_stale{false}, m_mutex{}
+  {
+  }
+
+  AugmentedList(const this_type& other)
+    : m_elements{other.m_elements}
+    , m_aggregates{}
+    , m_hash{}
+    , m_stale{false}
+    , m_mutex{}
+  {
+    // Another thread may be recomputing the aggregates of other.
+    const std::lock_guard<std::mutex> lock{other.m_mutex};
+    m_aggregates = other.m_aggregates;
+    m_hash       = other.m_hash;
+    m_stale.store(
+      other.m_stale.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+
+  this_type& operator=(const this_type& other)
+  {
+    this_type newList{other};
+    swap(newList);
+    return *this;
+  }
+
+  // O(1): takes over the elements and aggregates of other, which is left
+  // empty.
+  AugmentedList(this_type&& other) : AugmentedList{}
+  {
+    const std::lock_guard<std::mutex> lock{other.m_mutex};
+    swap(other);
+  }
+
+  this_type& operator=(this_type&& other)
+  {
+    this_type newList{std::move(other)};
+    swap(newList);
+    return *this;
+  }
+
+  AugmentedList(std::initializer_list<value_type> initList) : AugmentedList{}
+  {
+    for (const value_type& element : initList) { push_back(element); }
+  }
+
+  size_type size() const { return m_elements.size(); }
+
+  [[nodiscard]] bool empty() const { return m_elements.empty(); }
+
+  const_iterator begin() const { return m_elements.cbegin(); }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const { return m_elements.cend(); }
+
+  const_iterator cend() const { return end(); }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reference front() const { return m_elements.front(); }
+
+  const_reference back() const { return m_elements.back(); }
+
+  // The aggregate of the elements for Monoid, which has to be one of
+  // Monoids; O(1) unless it has to be recomputed.
+  template<typename Monoid>
+  const typename Monoid::value_type& aggregate() const
+  {
+    return currentValue(std::get<Aggregate<Monoid>>(m_aggregates));
+  }
+
+  // An order-sensitive hash of the elements; equal lists have equal hashes.
+  std::uint64_t hash() const
+    requires hashesElements
+  {
+    return currentValue(m_hash).hash;
+  }
+
+  void push_back(const_reference value)
+  {
+    m_elements.push_back(value);
+    added(value, Position::back);
+  }
+
+  void push_front(const_reference value)
+  {
+    m_elements.push_front(value);
+    added(value, Position::front);
+  }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    removed(back(), Position::back);
+    m_elements.pop_back();
+    resetIfEmpty();
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    removed(front(), Position::front);
+    m_elements.pop_front();
+    resetIfEmpty();
+  }
+
+  const_iterator insert(const_iterator pos, const_reference value)
+  {
+    const Position position{positionOf(pos, pos)};
+    const_iterator it{m_elements.insert(pos, value)};
+    added(value, position);
+    return it;
+  }
+
+  const_iterator erase(const_iterator pos)
+  {
+    removed(*pos, positionOf(pos, std::next(pos)));
+    const_iterator it{m_elements.erase(pos)};
+    resetIfEmpty();
+    return it;
+  }
+
+  void clear()
+  {
+    m_elements.clear();
+    resetIfEmpty();
+  }
+
+  void swap(this_type& other) noexcept
+  {
+    m_elements.swap(other.m_elements);
+    std::swap(m_aggregates, other.m_aggregates);
+    std::swap(m_hash, other.m_hash);
+    m_stale.store(
+      other.m_stale.exchange(
+        m_stale.load(std::memory_order_relaxed), std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  }
+
+private:
+  // Where the element at first, or the one that is inserted there, is
+  // with next being the element after it.
+  Position positionOf(const_iterator first, const_iterator next) const
+  {
+    if (first == begin()) { return Position::front; }
+
+    if (next == end()) { return Position::back; }
+
+    return Position::middle;
+  }
+
+  // Only takes the lock if any aggregate is stale. Once none is, the
+  // aggregates aren't written again until the list is modified, which
+  // mustn't happen concurrently with reading it.
+  template<typename Monoid>
+  const typename Monoid::value_type& currentValue(
+    Aggregate<Monoid>& aggregate) const
+  {
+    if (!m_stale.load(std::memory_order_acquire)) { return aggregate.value; }
+
+    const std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (aggregate.stale) {
+      typename Monoid::value_type value{Monoid::identity()};
+
+      for (const value_type& element : m_elements) {
+        value = Monoid::combine(value, Monoid::lift(element));
+      }
+
+      aggregate.value = std::move(value);
+      aggregate.stale = false;
+    }
+
+    if (!anyStale()) { m_stale.store(false, std::memory_order_release); }
+
+    return aggregate.value;
+  }
+
+  // Whether any aggregate has to be recomputed before it is read.
+  bool anyStale() const
+  {
+    bool stale{std::apply(
+      [](const auto&... aggregates) { return (aggregates.stale || ...); },
+      m_aggregates)};
+
+    if constexpr (hashesElements) { stale = stale || m_hash.stale; }
+
+    return stale;
+  }
+
+  template<typename Function>
+  void forEachAggregate(Function function)
+  {
+    std::apply(
+      [&function](auto&... aggregates) { (function(aggregates), ...); },
+      m_aggregates);
+
+    if constexpr (hashesElements) { function(m_hash); }
+  }
+
+  void added(const_reference element, Position position)
+  {
+    forEachAggregate([&element, position]<typename Monoid>(
+                       Aggregate<Monoid>& aggregate) {
+      if (aggregate.stale) { return; }
+
+      if (position == Position::back) {
+        aggregate.value
+          = Monoid::combine(aggregate.value, Monoid::lift(element));
+      }
+      else if (position == Position::front) {
+        aggregate.value
+          = Monoid::combine(Monoid::lift(element), aggregate.value);
+      }
+      else if constexpr (CommutativeMonoid<Monoid>) {
+        aggregate.value
+          = Monoid::combine(aggregate.value, Monoid::lift(element));
+      }
+      else {
+        aggregate.stale = true;
+      }
+    });
+    m_stale.store(anyStale(), std::memory_order_relaxed);
+  }
+
+  void removed(const_reference element, Position position)
+  {
+    forEachAggregate([&element, position]<typename Monoid>(
+                       Aggregate<Monoid>& aggregate) {
+      if (aggregate.stale) { return; }
+
+      if constexpr (InvertibleMonoid<Monoid>) {
+        const typename Monoid::value_type inverse{
+          Monoid::inverse(Monoid::lift(element))};
+
+        if (position == Position::back) {
+          aggregate.value = Monoid::combine(aggregate.value, inverse);
+          return;
+        }
+
+        if (position == Position::front) {
+          aggregate.value = Monoid::combine(inverse, aggregate.value);
+          return;
+        }
+
+        if constexpr (CommutativeMonoid<Monoid>) {
+          aggregate.value = Monoid::combine(aggregate.value, inverse);
+          return;
+        }
+      }
+
+      if constexpr (CommutativeMonoid<Monoid> && SelectiveMonoid<Monoid>) {
+        if (!(Monoid::lift(element) == aggregate.value)) { return; }
+      }
+
+      aggregate.stale = true;
+    });
+    m_stale.store(anyStale(), std::memory_order_relaxed);
+  }
+
+  void resetIfEmpty()
+  {
+    if (!empty()) { return; }
+
+    forEachAggregate([]<typename Monoid>(Aggregate<Monoid>& aggregate) {
+      aggregate = Aggregate<Monoid>{};
+    });
+    m_stale.store(false, std::memory_order_relaxed);
+  }
+
+  Elements                                 m_elements;
+  mutable std::tuple<Aggregate<Monoids>...> m_aggregates;
+  [[no_unique_address]] mutable Hash       m_hash;
+  // Whether any of the aggregates is stale.
+  mutable std::atomic<bool> m_stale;
+  // Guards recomputing the stale aggregates.
+  mutable std::mutex m_mutex;
+};
+
+template<typename Ty, typename... Monoids>
+void swap(
+  AugmentedList<Ty, Monoids...>& lhs,
+  AugmentedList<Ty, Monoids...>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+#endif // INCG_AUGMENTED_LIST_HPP
@@ -0,0 +1,369 @@
+#ifndef INCG_CHANNEL_HPP
+#define INCG_CHANNEL_HPP
+#include <cstddef>
+
+#include <coroutine>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "executor.hpp"
+#include "list.hpp"
+
+// A bounded multi producer, multi consumer queue for coroutines.
+// Its elements are kept in a List; producers and consumers that have to wait
+// for room or for elements are suspended instead of blocking their thread,
+// and are resumed on the channel's executor.
+//
+//   if (!co_await channel.push_back(value)) { /* channel was closed */ }
+//   std::optional<Ty> element{co_await channel.pop_front()};
+//   List<Ty>          batch{co_await channel.pop_many(64)};
+//
+// The channel must outlive all coroutines suspended on it.
+template<typename Ty>
+class Channel {
+public:
+  using value_type = Ty;
+  using this_type  = Channel;
+  using size_type  = std::size_t;
+
+private:
+  class ReceiveAwaiter {
+  public:
+    friend class Channel;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      return m_channel->suspendReceive(*this, handle);
+    }
+
+  protected:
+    ReceiveAwaiter(this_type& channel, size_type maxCount)
+      : m_channel{&channel}
+      , m_maxCount{maxCount}
+      , m_items{}
+      , m_handle{}
+      , m_next{nullptr}
+    {
+    }
+
+    this_type*              m_channel;
+    size_type               m_maxCount;
+    List<value_type>        m_items;
+    std::coroutine_handle<> m_handle;
+    ReceiveAwaiter*         m_next;
+  };
+
+public:
+  class PushAwaiter {
+  public:
+    friend class Channel;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      return m_channel->suspendPush(*this, handle);
+    }
+
+    // Returns false if the channel was closed before the element could be
+    // added.
+    bool await_resume() const noexcept { return m_accepted; }
+
+  private:
+    PushAwaiter(this_type& channel, const value_type& value)
+      : m_channel{&channel}
+      , m_value{value}
+      , m_accepted{false}
+      , m_handle{}
+      , m_next{nullptr}
+    {
+    }
+
+    this_type*              m_channel;
+    value_type              m_value;
+    bool                    m_accepted;
+    std::coroutine_handle<> m_handle;
+    PushAwaiter*            m_next;
+  };
+
+  class PopFrontAwaiter : public ReceiveAwaiter {
+  public:
+    friend class Channel;
+
+    // Returns std::nullopt if the channel is closed and drained.
+    std::optional<value_type> await_resume()
+    {
+      if (this->m_items.empty()) { return std::nullopt; }
+
+      return this->m_items.front();
+    }
+
+  private:
+    explicit PopFrontAwaiter(this_type& channel) : ReceiveAwaiter{channel, 1}
+    {
+    }
+  };
+
+  class PopManyAwaiter : public ReceiveAwaiter {
+  public:
+    friend class Channel;
+
+    // Returns an empty list if the channel is closed and drained.
+    List<value_type> await_resume()
+    {
+      List<value_type> items{};
+      items.swap(this->m_items);
+      return items;
+    }
+
+  private:
+    PopManyAwaiter(this_type& channel, size_type maxCount)
+      : ReceiveAwaiter{channel, maxCount}
+    {
+    }
+  };
+
+  Channel(Executor& executor, size_type capacity)
+    : m_executor{&executor}
+    , m_capacity{capacity}
+    , m_mutex{}
+    , m_buffer{}
+    , m_runs{}
+    , m_runLength{capacity}
+    , m_closed{false}
+    , m_senders{nullptr}
+    , m_lastSender{nullptr}
+    , m_receivers{nullptr}
+    , m_lastReceiver{nullptr}
+  {
+    if (m_capacity == 0) {
+      throw std::invalid_argument{"Channel: capacity must not be 0."};
+    }
+  }
+
+  Channel(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  size_type capacity() const { return m_capacity; }
+
+  // The number of buffered elements.
+  size_type size() const
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    return m_buffer.size();
+  }
+
+  // Suspends the calling coroutine while the channel is full.
+  PushAwaiter push_back(const value_type& value)
+  {
+    return PushAwaiter{*this, value};
+  }
+
+  // Suspends the calling coroutine while the channel is empty.
+  PopFrontAwaiter pop_front() { return PopFrontAwaiter{*this}; }
+
+  // Takes up to maxCount elements at once by splicing their nodes out of
+  // the buffer; only waits if the channel is empty.
+  // The buffer remembers where each run of maxCount elements pushed after
+  // the last pop_many starts, so that batches of the same size are split
+  // off in O(1); a batch that ends inside of a run walks to its end.
+  PopManyAwaiter pop_many(size_type maxCount)
+  {
+    if (maxCount == 0) {
+      throw std::invalid_argument{"Channel::pop_many: maxCount must not be 0."};
+    }
+
+    return PopManyAwaiter{*this, maxCount};
+  }
+
+  // Wakes all waiting coroutines. Pending and future pushes fail;
+  // consumers can still take the elements that are already buffered.
+  void close()
+  {
+    PushAwaiter*    senders{nullptr};
+    ReceiveAwaiter* receivers{nullptr};
+
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      m_closed  = true;
+      senders   = std::exchange(m_senders, nullptr);
+      receivers = std::exchange(m_receivers, nullptr);
+      m_lastSender   = nullptr;
+      m_lastReceiver = nullptr;
+    }
+
+    resumeAll(senders);
+    resumeAll(receivers);
+  }
+
+private:
+  // Consecutive buffered elements, the first of which is first.
+  struct Run {
+    typename List<value_type>::iterator first;
+    size_type                           count;
+  };
+
+  template<typename Awaiter>
+  static void append(Awaiter*& first, Awaiter*& last, Awaiter* awaiter)
+  {
+    if (last == nullptr) { first = awaiter; }
+    else {
+      last->m_next = awaiter;
+    }
+
+    last = awaiter;
+  }
+
+  template<typename Awaiter>
+  static Awaiter* takeFirst(Awaiter*& first, Awaiter*& last)
+  {
+    Awaiter* awaiter{first};
+
+    if (awaiter != nullptr) {
+      first = awaiter->m_next;
+
+      if (first == nullptr) { last = nullptr; }
+
+      awaiter->m_next = nullptr;
+    }
+
+    return awaiter;
+  }
+
+  // The next pointer has to be read before resuming a coroutine, which may
+  // destroy its awaiter.
+  template<typename Awaiter>
+  void resumeAll(Awaiter* awaiter)
+  {
+    while (awaiter != nullptr) {
+      Awaiter* next{awaiter->m_next};
+      m_executor->schedule(awaiter->m_handle);
+      awaiter = next;
+    }
+  }
+
+  // Returns whether the pushing coroutine has to be suspended.
+  bool suspendPush(PushAwaiter& sender, std::coroutine_handle<> handle)
+  {
+    ReceiveAwaiter* receiver{nullptr};
+
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+
+      if (m_closed) { return false; }
+
+      receiver = takeFirst(m_receivers, m_lastReceiver);
+
+      if (receiver != nullptr) {
+        receiver->m_items.push_back(sender.m_value);
+      }
+      else if (m_buffer.size() < m_capacity) {
+        buffer(sender.m_value);
+      }
+      else {
+        sender.m_handle = handle;
+        append(m_senders, m_lastSender, &sender);
+        return true;
+      }
+
+      sender.m_accepted = true;
+    }
+
+    if (receiver != nullptr) { m_executor->schedule(receiver->m_handle); }
+
+    return false;
+  }
+
+  // Returns whether the receiving coroutine has to be suspended.
+  bool suspendReceive(ReceiveAwaiter& receiver, std::coroutine_handle<> handle)
+  {
+    PushAwaiter* admitted{nullptr};
+    PushAwaiter* lastAdmitted{nullptr};
+
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+
+      if (m_buffer.empty()) {
+        if (m_closed) { return false; }
+
+        receiver.m_handle = handle;
+        append(m_receivers, m_lastReceiver, &receiver);
+        return true;
+      }
+
+      take(receiver.m_items, receiver.m_maxCount);
+
+      // Let waiting producers fill the room that was just made.
+      while (m_senders != nullptr && m_buffer.size() < m_capacity) {
+        PushAwaiter* sender{takeFirst(m_senders, m_lastSender)};
+        buffer(sender->m_value);
+        sender->m_accepted = true;
+        append(admitted, lastAdmitted, sender);
+      }
+    }
+
+    resumeAll(admitted);
+    return false;
+  }
+
+  void buffer(const value_type& value)
+  {
+    m_buffer.push_back(value);
+
+    if (m_runs.empty() || m_runs.back().count >= m_runLength) {
+      m_runs.push_back(Run{std::prev(m_buffer.end()), 1});
+    }
+    else {
+      ++m_runs.back().count;
+    }
+  }
+
+  // Splices up to maxCount elements from the front of the buffer to the end
+  // of items, taking whole runs without walking their nodes.
+  void take(List<value_type>& items, size_type maxCount)
+  {
+    size_type count{0};
+
+    while (!m_runs.empty() && count + m_runs.front().count <= maxCount) {
+      count += m_runs.front().count;
+      m_runs.pop_front();
+    }
+
+    typename List<value_type>::iterator last{m_buffer.end()};
+
+    if (!m_runs.empty()) {
+      Run&            run{m_runs.front()};
+      const size_type rest{maxCount - count};
+
+      std::advance(run.first, rest);
+      run.count -= rest;
+      count += rest;
+      last = run.first;
+    }
+
+    items.splice(items.end(), m_buffer, m_buffer.begin(), last, count);
+
+    // Consumers that take batches get their runs from now on.
+    if (maxCount > 1) { m_runLength = maxCount; }
+  }
+
+  Executor*          m_executor;
+  size_type          m_capacity;
+  mutable std::mutex m_mutex;
+  List<value_type>   m_buffer;
+  std::deque<Run>    m_runs;
+  size_type          m_runLength;
+  bool               m_closed;
+  PushAwaiter*       m_senders;
+  PushAwaiter*       m_lastSender;
+  ReceiveAwaiter*    m_receivers;
+  ReceiveAwaiter*    m_lastReceiver;
+};
+#endif // INCG_CHANNEL_HPP
@@ -0,0 +1,521 @@
+#ifndef INCG_COMPRESSED_INT_LIST_HPP
+#define INCG_COMPRESSED_INT_LIST_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <initializer_list>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "list.hpp"
+
+// A sequence of integers that stores them delta encoded in linked chunks:
+// every chunk keeps its first element as is and every further element as
+// the varint of the zigzag encoded difference to the element before it.
+// Sequences that mostly increase in small steps, like IDs, take about one
+// byte per element instead of the 24 bytes of a List<std::int64_t> node.
+// The chunks are the elements of a List, so they come from its slabs.
+// Elements are decoded while iterating, so they can't be modified in place
+// and dereferencing an iterator returns a copy.
+// insert and erase only re-encode the chunk that holds the position, which
+// may split it, and invalidate the iterators into it.
+template<std::integral Ty = std::int64_t>
+class CompressedIntList {
+public:
+  using value_type      = Ty;
+  using this_type       = CompressedIntList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = value_type;
+  using const_reference = value_type;
+
+  // The number of bytes of encoded differences a chunk can hold.
+  static constexpr size_type chunkCapacity{220};
+
+private:
+  struct Chunk {
+    value_type    first;
+    value_type    last;
+    std::uint16_t count;
+    std::uint16_t bytes;
+    unsigned char data[chunkCapacity];
+  };
+
+  using Chunks = List<Chunk, ListConfig{.usesSlabs = true}>;
+
+  // Chunks hold at most one element more than differences fit in.
+  static constexpr size_type maxChunkSize{chunkCapacity + 1};
+
+public:
+  class const_iterator {
+  public:
+    friend class CompressedIntList;
+
+    using difference_type   = typename CompressedIntList::difference_type;
+    using value_type        = typename CompressedIntList::value_type;
+    using pointer           = void;
+    using reference         = value_type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_chunk == rhs.m_chunk && lhs.m_offset == rhs.m_offset;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "CompressedIntList::const_iterator{" << cit.m_chunk << ", "
+                << cit.m_offset << '}';
+    }
+
+    const_iterator() : m_chunk{}, m_end{}, m_offset{0}, m_value{} {}
+
+    value_type operator*() const { return m_value; }
+
+    const_iterator& operator++()
+    {
+      if (m_offset == m_chunk->bytes) {
+        ++m_chunk;
+        m_offset = 0;
+
+        if (m_chunk != m_end) { m_value = m_chunk->first; }
+
+        return *this;
+      }
+
+      const unsigned char* const data{m_chunk->data + m_offset};
+      std::uint64_t              zigzag{0};
+      m_offset = static_cast<std::uint16_t>(
+        m_offset + (readVarint(data, zigzag) - data));
+      m_value = addDifference(m_value, zigzag);
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      if (m_offset == 0) {
+        --m_chunk;
+        m_offset = m_chunk->bytes;
+        m_value  = m_chunk->last;
+        return *this;
+      }
+
+      // Only the last byte of a varint has the high bit cleared.
+      std::uint16_t begin{static_cast<std::uint16_t>(m_offset - 1)};
+
+      while (begin != 0 && (m_chunk->data[begin - 1] & 0x80) != 0) { --begin; }
+
+      std::uint64_t zigzag{0};
+      readVarint(m_chunk->data + begin, zigzag);
+      m_value  = subtractDifference(m_value, zigzag);
+      m_offset = begin;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    using ChunkIterator = typename Chunks::const_iterator;
+
+    // offset is where the difference to the next element starts in the
+    // data of chunk, i.e. 0 for the first element of a chunk.
+    const_iterator(
+      ChunkIterator chunk,
+      ChunkIterator end,
+      std::uint16_t offset,
+      value_type    value)
+      : m_chunk{chunk}, m_end{end}, m_offset{offset}, m_value{value}
+    {
+    }
+
+    ChunkIterator m_chunk;
+    ChunkIterator m_end;
+    std::uint16_t m_offset;
+    value_type    m_value;
+  };
+
+  using iterator               = const_iterator;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "CompressedIntList[]"; }
+
+    os << "CompressedIntList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  {
+    return lhs.size() == rhs.size()
+           && std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  CompressedIntList() : m_chunks{}, m_size{0} {}
+
+  CompressedIntList(std::initializer_list<value_type> initList)
+    : CompressedIntList{}
+  {
+    for (const value_type& elementToAdd : initList) { push_back(elementToAdd); }
+  }
+
+  size_type size() const { return m_size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  // The number of bytes taken by the chunks, not counting the links between
+  // them.
+  size_type memory_usage() const { return m_chunks.size() * sizeof(Chunk); }
+
+  value_type front() const
+  {
+    if (empty()) {
+      throw std::out_of_range{
+        "CompressedIntList::front called on empty list."};
+    }
+
+    return m_chunks.front().first;
+  }
+
+  value_type back() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"CompressedIntList::back called on empty list."};
+    }
+
+    return m_chunks.back().last;
+  }
+
+  const_iterator begin() const
+  {
+    if (empty()) { return end(); }
+
+    return const_iterator{
+      m_chunks.begin(), m_chunks.end(), 0, m_chunks.front().first};
+  }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const
+  {
+    return const_iterator{m_chunks.end(), m_chunks.end(), 0, value_type{}};
+  }
+
+  const_iterator cend() const { return end(); }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  void push_back(value_type value)
+  {
+    if (!empty()) {
+      Chunk&              chunk{m_chunks.back()};
+      const std::uint64_t zigzag{difference(chunk.last, value)};
+
+      if (varintSize(zigzag) <= chunkCapacity - chunk.bytes) {
+        chunk.bytes = static_cast<std::uint16_t>(
+          writeVarint(chunk.data + chunk.bytes, zigzag) - chunk.data);
+        chunk.last = value;
+        ++chunk.count;
+        ++m_size;
+        return;
+      }
+    }
+
+    m_chunks.push_back(Chunk{value, value, 1, 0, {}});
+    ++m_size;
+  }
+
+  void pop_back()
+  {
+    if (empty()) {
+      throw std::out_of_range{
+        "CompressedIntList::pop_back called on empty list."};
+    }
+
+    erase(std::prev(end()));
+  }
+
+  // Inserts value in front of pos and returns an iterator to it.
+  iterator insert(const_iterator pos, value_type value)
+  {
+    if (pos == end()) {
+      push_back(value);
+      return std::prev(end());
+    }
+
+    std::array<value_type, maxChunkSize + 1> values{};
+    const size_type index{decodeChunk(pos, values.data())};
+    const size_type count{pos.m_chunk->count};
+
+    std::copy_backward(
+      values.begin() + static_cast<difference_type>(index),
+      values.begin() + static_cast<difference_type>(count),
+      values.begin() + static_cast<difference_type>(count + 1));
+    values[index] = value;
+
+    const iterator inserted{
+      rewriteChunk(pos.m_chunk, values.data(), count + 1, index)};
+    ++m_size;
+    return inserted;
+  }
+
+  // Returns an iterator to the element following the erased one.
+  iterator erase(const_iterator pos)
+  {
+    std::array<value_type, maxChunkSize> values{};
+    const size_type index{decodeChunk(pos, values.data())};
+    const size_type count{pos.m_chunk->count};
+
+    std::copy(
+      values.begin() + static_cast<difference_type>(index + 1),
+      values.begin() + static_cast<difference_type>(count),
+      values.begin() + static_cast<difference_type>(index));
+
+    const iterator following{
+      rewriteChunk(pos.m_chunk, values.data(), count - 1, index)};
+    --m_size;
+    return following;
+  }
+
+  void clear()
+  {
+    m_chunks.clear();
+    m_size = 0;
+  }
+
+  // Writes all elements to out, which is faster than iterating over them:
+  // differences that fit into a byte are decoded eight at a time.
+  template<std::output_iterator<value_type> OutputIterator>
+  OutputIterator decode(OutputIterator out) const
+  {
+    for (const Chunk& chunk : m_chunks) {
+      value_type                 value{chunk.first};
+      const unsigned char*       data{chunk.data};
+      const unsigned char* const end{chunk.data + chunk.bytes};
+      *out++ = value;
+
+      while (data != end) {
+        if (end - data >= 8 && allBelow0x80(data)) {
+          for (int i{0}; i < 8; ++i) {
+            value  = addDifference(value, data[i]);
+            *out++ = value;
+          }
+
+          data += 8;
+          continue;
+        }
+
+        std::uint64_t zigzag{0};
+        data   = readVarint(data, zigzag);
+        value  = addDifference(value, zigzag);
+        *out++ = value;
+      }
+    }
+
+    return out;
+  }
+
+private:
+  using ChunkIterator = typename Chunks::const_iterator;
+
+  static std::uint64_t difference(value_type from, value_type to)
+  {
+    const std::uint64_t delta{
+      static_cast<std::uint64_t>(to) - static_cast<std::uint64_t>(from)};
+    return (delta << 1) ^ (delta >> 63 != 0 ? ~std::uint64_t{0} : 0);
+  }
+
+  static std::uint64_t undoZigzag(std::uint64_t zigzag)
+  {
+    return (zigzag >> 1) ^ (std::uint64_t{0} - (zigzag & 1));
+  }
+
+  static value_type addDifference(value_type value, std::uint64_t zigzag)
+  {
+    return static_cast<value_type>(
+      static_cast<std::uint64_t>(value) + undoZigzag(zigzag));
+  }
+
+  static value_type subtractDifference(value_type value, std::uint64_t zigzag)
+  {
+    return static_cast<value_type>(
+      static_cast<std::uint64_t>(value) - undoZigzag(zigzag));
+  }
+
+  static size_type varintSize(std::uint64_t value)
+  {
+    size_type size{1};
+
+    for (; value >= 0x80; value >>= 7) { ++size; }
+
+    return size;
+  }
+
+  static unsigned char* writeVarint(unsigned char* out, std::uint64_t value)
+  {
+    for (; value >= 0x80; value >>= 7) {
+      *out++ = static_cast<unsigned char>(value | 0x80);
+    }
+
+    *out++ = static_cast<unsigned char>(value);
+    return out;
+  }
+
+  static const unsigned char* readVarint(
+    const unsigned char* in,
+    std::uint64_t&       value)
+  {
+    value = 0;
+
+    for (int shift{0};; shift += 7) {
+      const unsigned char byte{*in++};
+      value |= std::uint64_t{byte & 0x7fu} << shift;
+
+      if ((byte & 0x80) == 0) { return in; }
+    }
+  }
+
+  static bool allBelow0x80(const unsigned char* data)
+  {
+    std::uint64_t word{};
+    std::memcpy(&word, data, sizeof(word));
+    return (word & 0x8080808080808080) == 0;
+  }
+
+  // Decodes the chunk of pos into values and returns the index of pos in it.
+  static size_type decodeChunk(const_iterator pos, value_type* values)
+  {
+    const Chunk&         chunk{*pos.m_chunk};
+    const unsigned char* data{chunk.data};
+    size_type            index{0};
+    values[0] = chunk.first;
+
+    for (size_type i{1}; i < chunk.count; ++i) {
+      if (data - chunk.data == pos.m_offset) { index = i - 1; }
+
+      std::uint64_t zigzag{0};
+      data      = readVarint(data, zigzag);
+      values[i] = addDifference(values[i - 1], zigzag);
+    }
+
+    if (data - chunk.data == pos.m_offset) { index = chunk.count - 1; }
+
+    return index;
+  }
+
+  // Replaces the elements of chunk with the count values, splitting them
+  // into further chunks where they don't fit, and returns an iterator to
+  // the one at index, or to the element following the chunks if index is
+  // count.
+  // The new chunks are inserted in front of the old one before it is
+  // erased, so the list is left as it was if allocating one of them throws.
+  iterator rewriteChunk(
+    ChunkIterator     position,
+    const value_type* values,
+    size_type         count,
+    size_type         index)
+  {
+    if (count == 0) { return iteratorTo(m_chunks.erase(position)); }
+
+    typename Chunks::iterator chunk{
+      m_chunks.insert(position, Chunk{values[0], values[0], 1, 0, {}})};
+    const typename Chunks::iterator first{chunk};
+
+    try {
+      for (size_type i{1}; i < count; ++i) {
+        const std::uint64_t zigzag{difference(values[i - 1], values[i])};
+
+        if (varintSize(zigzag) > chunkCapacity - chunk->bytes) {
+          chunk = m_chunks.insert(
+            position, Chunk{values[i], values[i], 1, 0, {}});
+          continue;
+        }
+
+        chunk->bytes = static_cast<std::uint16_t>(
+          writeVarint(chunk->data + chunk->bytes, zigzag) - chunk->data);
+        chunk->last = values[i];
+        ++chunk->count;
+      }
+    }
+    catch (...) {
+      for (ChunkIterator it{first}; it != position;) {
+        it = m_chunks.erase(it);
+      }
+
+      throw;
+    }
+
+    m_chunks.erase(position);
+
+    const_iterator it{iteratorTo(first)};
+
+    for (size_type i{0}; i < index; ++i) { ++it; }
+
+    return it;
+  }
+
+  const_iterator iteratorTo(ChunkIterator chunk) const
+  {
+    if (chunk == m_chunks.end()) { return end(); }
+
+    return const_iterator{chunk, m_chunks.end(), 0, chunk->first};
+  }
+
+  Chunks    m_chunks;
+  size_type m_size;
+};
+#endif // INCG_COMPRESSED_INT_LIST_HPP
@@ -0,0 +1,180 @@
+#ifndef INCG_EXECUTOR_HPP
+#define INCG_EXECUTOR_HPP
+#include <cstddef>
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Resumes suspended coroutines.
+class Executor {
+public:
+  virtual ~Executor() = default;
+
+  // Arranges for handle to be resumed; may be called from any thread that
+  // the concrete executor supports.
+  virtual void schedule(std::coroutine_handle<> handle) = 0;
+};
+
+// Resumes coroutines on the thread that calls run().
+// schedule may only be called from that thread.
+class SingleThreadedExecutor final : public Executor {
+public:
+  SingleThreadedExecutor() : m_queue{} {}
+
+  void schedule(std::coroutine_handle<> handle) override
+  {
+    m_queue.push_back(handle);
+  }
+
+  // Resumes coroutines until none are ready to run anymore.
+  void run()
+  {
+    while (!m_queue.empty()) {
+      const std::coroutine_handle<> handle{m_queue.front()};
+      m_queue.pop_front();
+      handle.resume();
+    }
+  }
+
+private:
+  std::deque<std::coroutine_handle<>> m_queue;
+};
+
+// Resumes coroutines on a fixed number of worker threads.
+class ThreadPoolExecutor final : public Executor {
+public:
+  explicit ThreadPoolExecutor(std::size_t threadCount)
+    : m_mutex{}
+    , m_workAvailable{}
+    , m_idle{}
+    , m_queue{}
+    , m_running{0}
+    , m_stopping{false}
+    , m_threads{}
+  {
+    for (std::size_t i{0}; i < threadCount; ++i) {
+      m_threads.emplace_back([this] { work(); });
+    }
+  }
+
+  ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+
+  ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+  ~ThreadPoolExecutor() override
+  {
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      m_stopping = true;
+    }
+
+    m_workAvailable.notify_all();
+
+    for (std::thread& thread : m_threads) { thread.join(); }
+  }
+
+  void schedule(std::coroutine_handle<> handle) override
+  {
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      m_queue.push_back(handle);
+    }
+
+    m_workAvailable.notify_one();
+  }
+
+  // Blocks until no coroutine is ready to run or running anymore.
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_idle.wait(lock, [this] { return m_queue.empty() && m_running == 0; });
+  }
+
+private:
+  void work()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (true) {
+      m_workAvailable.wait(
+        lock, [this] { return m_stopping || !m_queue.empty(); });
+
+      if (m_queue.empty()) { return; }
+
+      const std::coroutine_handle<> handle{m_queue.front()};
+      m_queue.pop_front();
+      ++m_running;
+      lock.unlock();
+      handle.resume();
+      lock.lock();
+      --m_running;
+
+      if (m_queue.empty() && m_running == 0) { m_idle.notify_all(); }
+    }
+  }
+
+  std::mutex                          m_mutex;
+  std::condition_variable             m_workAvailable;
+  std::condition_variable             m_idle;
+  std::deque<std::coroutine_handle<>> m_queue;
+  std::size_t                         m_running;
+  bool                                m_stopping;
+  std::vector<std::thread>            m_threads;
+};
+
+// A coroutine that starts running once it's spawned on an executor and that
+// destroys itself when it finishes.
+class Task {
+public:
+  struct promise_type {
+    Task get_return_object()
+    {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    std::suspend_never final_suspend() noexcept { return {}; }
+
+    void return_void() {}
+
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  Task(const Task&) = delete;
+
+  Task& operator=(const Task&) = delete;
+
+  Task(Task&& other) noexcept : m_handle{std::exchange(other.m_handle, {})} {}
+
+  Task& operator=(Task&& other) noexcept
+  {
+    Task newTask{std::move(other)};
+    std::swap(m_handle, newTask.m_handle);
+    return *this;
+  }
+
+  ~Task()
+  {
+    if (m_handle) { m_handle.destroy(); }
+  }
+
+  friend void spawn(Executor& executor, Task task)
+  {
+    executor.schedule(std::exchange(task.m_handle, {}));
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : m_handle{handle}
+  {
+  }
+
+  std::coroutine_handle<promise_type> m_handle;
+};
+#endif // INCG_EXECUTOR_HPP
@@ -0,0 +1,177 @@
+#ifndef INCG_HUGE_PAGE_ARENA_HPP
+#define INCG_HUGE_PAGE_ARENA_HPP
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+// Hands out memory from large anonymous mappings that the kernel is asked
+// to back with transparent huge pages, so that traversing millions of nodes
+// needs a TLB entry per 2 MiB instead of per 4 KiB.
+// Blocks are bump allocated one after the other; freed blocks are kept for
+// allocations of the same size and alignment and the mappings are only
+// returned to the system by the destructor, so the arena has to outlive
+// every block it handed out.
+// Falls back to regular pages where huge pages aren't available, see
+// uses_huge_pages. May be used from any thread.
+class HugePageArena {
+public:
+  static constexpr std::size_t hugePageSize{std::size_t{2} << 20};
+
+  // Maps regionSize bytes, rounded up to whole huge pages, at a time.
+  explicit HugePageArena(std::size_t regionSize = std::size_t{64} << 20)
+    : m_mutex{}
+    , m_regionSize{roundUp(regionSize, hugePageSize)}
+    , m_regions{}
+    , m_next{nullptr}
+    , m_regionEnd{nullptr}
+    , m_freeBlocks{}
+    , m_usesHugePages{true}
+  {
+  }
+
+  HugePageArena(const HugePageArena&) = delete;
+
+  HugePageArena& operator=(const HugePageArena&) = delete;
+
+  ~HugePageArena()
+  {
+    for (const auto& [region, size] : m_regions) { ::munmap(region, size); }
+  }
+
+  // alignment has to be a power of two of at most hugePageSize.
+  void* allocate(std::size_t size, std::size_t alignment)
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (const auto it{m_freeBlocks.find({size, alignment})};
+        it != m_freeBlocks.end() && !it->second.empty()) {
+      void* const block{it->second.back()};
+      it->second.pop_back();
+      return block;
+    }
+
+    char* block{alignUp(m_next, alignment)};
+
+    if (
+      m_next == nullptr
+      || size > static_cast<std::size_t>(m_regionEnd - block)) {
+      mapRegion(size);
+      block = m_next;
+    }
+
+    m_next = block + size;
+    return block;
+  }
+
+  // Makes a block returned by allocate(size, alignment) available for
+  // reuse.
+  void deallocate(void* block, std::size_t size, std::size_t alignment)
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    m_freeBlocks[{size, alignment}].push_back(block);
+  }
+
+  // Whether the kernel accepted the request for huge pages for all regions
+  // mapped so far; it may still back parts of them with regular pages.
+  bool uses_huge_pages() const
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    return m_usesHugePages;
+  }
+
+  // The number of bytes mapped.
+  std::size_t reserved() const
+  {
+    const std::lock_guard<std::mutex> lock{m_mutex};
+    std::size_t                       bytes{0};
+
+    for (const auto& region : m_regions) { bytes += region.second; }
+
+    return bytes;
+  }
+
+private:
+  // The freed blocks by their size and alignment.
+  using FreeBlocks
+    = std::map<std::pair<std::size_t, std::size_t>, std::vector<void*>>;
+
+  static std::size_t roundUp(std::size_t size, std::size_t alignment)
+  {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  static char* alignUp(char* pointer, std::size_t alignment)
+  {
+    const std::uintptr_t address{reinterpret_cast<std::uintptr_t>(pointer)};
+    return reinterpret_cast<char*>(
+      (address + alignment - 1) & ~std::uintptr_t{alignment - 1});
+  }
+
+  // Starts a new region that is aligned to hugePageSize and has room for at
+  // least minimumSize bytes; the rest of the current one is abandoned.
+  void mapRegion(std::size_t minimumSize)
+  {
+    const std::size_t size{
+      std::max(m_regionSize, roundUp(minimumSize, hugePageSize))};
+
+    // Recording the region can't fail once it is mapped.
+    m_regions.reserve(m_regions.size() + 1);
+
+    // mmap only aligns to regular pages; map an extra huge page and unmap
+    // what lies outside of the aligned region.
+    void* const mapping{::mmap(
+      nullptr,
+      size + hugePageSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0)};
+
+    if (mapping == MAP_FAILED) {
+      throw std::system_error{
+        errno, std::generic_category(), "HugePageArena: mmap failed"};
+    }
+
+    char* const begin{static_cast<char*>(mapping)};
+    char* const region{alignUp(begin, hugePageSize)};
+    char* const end{begin + size + hugePageSize};
+
+    if (region != begin) {
+      ::munmap(begin, static_cast<std::size_t>(region - begin));
+    }
+
+    if (region + size != end) {
+      ::munmap(region + size, static_cast<std::size_t>(end - (region + size)));
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (::madvise(region, size, MADV_HUGEPAGE) != 0) {
+      m_usesHugePages = false;
+    }
+#else
+    m_usesHugePages = false;
+#endif
+
+    m_regions.emplace_back(region, size);
+    m_next      = region;
+    m_regionEnd = region + size;
+  }
+
+  mutable std::mutex                         m_mutex;
+  std::size_t                                m_regionSize;
+  std::vector<std::pair<char*, std::size_t>> m_regions;
+  char*                                      m_next;
+  char*                                      m_regionEnd;
+  FreeBlocks                                 m_freeBlocks;
+  bool                                       m_usesHugePages;
+};
+#endif // INCG_HUGE_PAGE_ARENA_HPP
@@ -0,0 +1,568 @@
+#ifndef INCG_LINKED_HASH_LIST_HPP
+#define INCG_LINKED_HASH_LIST_HPP
+#include <cstddef>
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "allocation_tracking.hpp"
+
+// A list that keeps its elements in insertion order and indexes them in a
+// hash table, so that contains, find, count and erase by value are O(1) on
+// average instead of a linear scan.
+// By default it is a set: inserting a value that is already contained returns
+// the element that is already there. With AllowDuplicates it is a multiset
+// and find returns any one of the equal elements.
+// The index is an open addressing table with linear probing that maps the
+// hash of an element to its node; nodes never move, so iterators stay valid
+// until their element is erased.
+// Elements can't be modified through iterators, as that would break the
+// index.
+template<
+  typename Ty,
+  typename Hash        = std::hash<Ty>,
+  typename Equal       = std::equal_to<Ty>,
+  bool AllowDuplicates = false>
+class LinkedHashList {
+public:
+  using value_type      = Ty;
+  using this_type       = LinkedHashList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = const value_type&;
+  using const_reference = const value_type&;
+  using hasher          = Hash;
+  using key_equal       = Equal;
+
+private:
+  struct Node {
+    value_type value;
+    Node*      prev;
+    Node*      next;
+    size_type  hash;
+  };
+
+  // A slot without a node is empty if hash is 0 and a tombstone, i.e. the
+  // slot of an erased element that lookups have to probe past, otherwise.
+  struct Slot {
+    Node*     node;
+    size_type hash;
+  };
+
+public:
+  class const_iterator {
+  public:
+    friend class LinkedHashList;
+
+    using difference_type   = typename LinkedHashList::difference_type;
+    using value_type        = typename LinkedHashList::value_type;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_node == rhs.m_node;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "LinkedHashList::const_iterator{" << cit.m_node << '}';
+    }
+
+    const value_type& operator*() const { return m_node->value; }
+
+    const value_type* operator->() const { return &m_node->value; }
+
+    const_iterator& operator++()
+    {
+      m_node = m_node->next;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      m_node = m_node->prev;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    explicit const_iterator(Node* node) : m_node{node} {}
+
+    Node* m_node;
+  };
+
+  using iterator               = const_iterator;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "LinkedHashList[]"; }
+
+    os << "LinkedHashList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  // Compares the elements in iteration order, like List does.
+  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  {
+    return std::equal(
+      lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), lhs.m_equal);
+  }
+
+  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  LinkedHashList()
+    : m_begin{nullptr}
+    , m_end{nullptr}
+    , m_size{0}
+    , m_slots{}
+    , m_usedSlots{0}
+    , m_hash{}
+    , m_equal{}
+  {
+    initialize();
+  }
+
+  LinkedHashList(const this_type& other) : LinkedHashList{}
+  {
+    for (const value_type& element : other) { push_back(element); }
+  }
+
+  LinkedHashList(std::initializer_list<value_type> initList)
+    : LinkedHashList{}
+  {
+    for (const value_type& elementToAdd : initList) { push_back(elementToAdd); }
+  }
+
+  this_type& operator=(const this_type& other)
+  {
+    this_type newList{other};
+    swap(newList);
+    return *this;
+  }
+
+  ~LinkedHashList() { destroy(); }
+
+  size_type size() const { return m_size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  const_reference front() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"LinkedHashList::front called on empty list."};
+    }
+
+    return *begin();
+  }
+
+  const_reference back() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"LinkedHashList::back called on empty list."};
+    }
+
+    return *std::prev(end());
+  }
+
+  const_iterator begin() const { return const_iterator{m_begin}; }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const { return const_iterator{m_end}; }
+
+  const_iterator cend() const { return end(); }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  bool contains(const_reference value) const { return find(value) != end(); }
+
+  // O(1) on average.
+  const_iterator find(const_reference value) const
+  {
+    if (empty()) { return end(); }
+
+    const size_type hash{m_hash(value)};
+    Node*           found{nullptr};
+
+    forEachCandidate(hash, [&](Node* node) {
+      if (!m_equal(node->value, value)) { return true; }
+
+      found = node;
+      return false;
+    });
+
+    return found == nullptr ? end() : const_iterator{found};
+  }
+
+  // O(1) on average, plus the number of equal elements.
+  size_type count(const_reference value) const
+  {
+    if (empty()) { return 0; }
+
+    size_type result{0};
+
+    forEachCandidate(m_hash(value), [&](Node* node) {
+      if (m_equal(node->value, value)) { ++result; }
+
+      return true;
+    });
+
+    return result;
+  }
+
+  void sort() { sort(std::less<value_type>{}); }
+
+  // Relinks the nodes, the index stays valid as is.
+  template<typename BinaryComparator>
+  void sort(BinaryComparator binaryComparator)
+  {
+    if (size() < 2) { return; }
+
+    std::vector<Node*> nodes{};
+    nodes.reserve(size());
+
+    for (Node* node{m_begin}; node != m_end; node = node->next) {
+      nodes.push_back(node);
+    }
+
+    std::stable_sort(
+      nodes.begin(), nodes.end(), [&binaryComparator](Node* lhs, Node* rhs) {
+        return std::invoke(binaryComparator, lhs->value, rhs->value);
+      });
+
+    Node* prev{nullptr};
+
+    for (Node* node : nodes) {
+      node->prev = prev;
+
+      if (prev == nullptr) { m_begin = node; }
+      else {
+        prev->next = node;
+      }
+
+      prev = node;
+    }
+
+    prev->next  = m_end;
+    m_end->prev = prev;
+  }
+
+  void push_back(const_reference element) { insert(end(), element); }
+
+  void push_front(const_reference element) { insert(begin(), element); }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    erase(std::prev(end()));
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    erase(begin());
+  }
+
+  // Unless duplicates are allowed, returns the element equal to value
+  // without inserting anything if there already is one.
+  iterator insert(const_iterator pos, const_reference value)
+  {
+    const size_type hash{m_hash(value)};
+
+    if constexpr (!AllowDuplicates) {
+      const const_iterator it{find(value)};
+
+      if (it != end()) { return it; }
+    }
+
+    reserveSlot();
+
+    Node* node{pos.m_node};
+    Node* prev{node->prev};
+    Node* newNode{nullptr};
+
+    try {
+      newNode = new Node{value, prev, node, hash};
+      trackAllocation(newNode);
+    }
+    catch (...) {
+      trackDeallocation(newNode);
+      delete newNode;
+      throw;
+    }
+
+    if (node == m_begin) { m_begin = newNode; }
+    else {
+      prev->next = newNode;
+    }
+
+    node->prev = newNode;
+    ++m_size;
+    addToIndex(newNode);
+    return iterator{newNode};
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    Node* node{pos.m_node};
+    Node* next{node->next};
+
+    removeFromIndex(node);
+
+    if (node == m_begin) {
+      m_begin    = next;
+      next->prev = nullptr;
+    }
+    else {
+      node->prev->next = next;
+      next->prev       = node->prev;
+    }
+
+    --m_size;
+    trackDeallocation(node);
+    delete node;
+    return iterator{next};
+  }
+
+  // Erases all elements equal to value in O(1) on average, plus the number
+  // of equal elements.
+  // value may refer to one of the elements, so a set looks it up only once
+  // and a multiset looks up a copy of it.
+  size_type erase(const_reference value)
+  {
+    if constexpr (!AllowDuplicates) {
+      const const_iterator it{find(value)};
+
+      if (it == end()) { return 0; }
+
+      erase(it);
+      return 1;
+    }
+    else {
+      const value_type key{value};
+      size_type        elementsRemoved{0};
+
+      for (const_iterator it{find(key)}; it != end(); it = find(key)) {
+        erase(it);
+        ++elementsRemoved;
+      }
+
+      return elementsRemoved;
+    }
+  }
+
+  template<typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate unaryPredicate)
+  {
+    size_type elementsRemoved{0};
+
+    iterator it{begin()};
+
+    while (it != end()) {
+      if (std::invoke(unaryPredicate, *it)) {
+        it = erase(it);
+        ++elementsRemoved;
+      }
+      else {
+        ++it;
+      }
+    }
+
+    return elementsRemoved;
+  }
+
+  size_type remove(const_reference value) { return erase(value); }
+
+  void clear()
+  {
+    this_type newList{};
+    swap(newList);
+  }
+
+  void swap(this_type& other) noexcept
+  {
+    using std::swap;
+    swap(m_begin, other.m_begin);
+    swap(m_end, other.m_end);
+    swap(m_size, other.m_size);
+    swap(m_slots, other.m_slots);
+    swap(m_usedSlots, other.m_usedSlots);
+    swap(m_hash, other.m_hash);
+    swap(m_equal, other.m_equal);
+  }
+
+private:
+  static constexpr size_type minimumSlotCount{16};
+
+  size_type slotMask() const { return m_slots.size() - 1; }
+
+  // Calls callback(node) for every node whose hash equals hash until it
+  // returns false.
+  template<typename Callback>
+  void forEachCandidate(size_type hash, Callback callback) const
+  {
+    for (size_type i{hash & slotMask()};; i = (i + 1) & slotMask()) {
+      const Slot& slot{m_slots[i]};
+
+      if (slot.node == nullptr) {
+        if (slot.hash == 0) { return; }
+
+        continue;
+      }
+
+      if (slot.hash == hash && !callback(slot.node)) { return; }
+    }
+  }
+
+  // Makes sure that the table has room for one more element with at most
+  // half of its slots in use, counting tombstones.
+  void reserveSlot()
+  {
+    if (2 * (m_usedSlots + 1) <= m_slots.size()) { return; }
+
+    size_type slotCount{std::max(m_slots.size(), minimumSlotCount)};
+
+    while (2 * (m_size + 1) > slotCount / 2) { slotCount *= 2; }
+
+    std::vector<Slot> slots(slotCount, Slot{nullptr, 0});
+    m_slots.swap(slots);
+    m_usedSlots = 0;
+
+    for (Node* node{m_begin}; node != m_end; node = node->next) {
+      addToIndex(node);
+    }
+  }
+
+  void addToIndex(Node* node)
+  {
+    for (size_type i{node->hash & slotMask()};; i = (i + 1) & slotMask()) {
+      Slot& slot{m_slots[i]};
+
+      if (slot.node == nullptr) {
+        if (slot.hash == 0) { ++m_usedSlots; }
+
+        slot = Slot{node, node->hash};
+        return;
+      }
+    }
+  }
+
+  void removeFromIndex(Node* node)
+  {
+    for (size_type i{node->hash & slotMask()};; i = (i + 1) & slotMask()) {
+      Slot& slot{m_slots[i]};
+
+      if (slot.node == node) {
+        slot = Slot{nullptr, 1};
+        return;
+      }
+    }
+  }
+
+  void initialize()
+  {
+    try {
+      m_begin = new Node{value_type{}, nullptr, nullptr, 0};
+      trackAllocation(m_begin);
+      m_end = m_begin;
+    }
+    catch (...) {
+      trackDeallocation(m_begin);
+      delete m_begin;
+      m_begin = nullptr;
+      throw;
+    }
+  }
+
+  void destroy()
+  {
+    Node* node{m_begin};
+
+    while (node != m_end) {
+      node = node->next;
+      trackDeallocation(node->prev);
+      delete node->prev;
+    }
+
+    trackDeallocation(m_end);
+    delete m_end;
+
+    m_begin = nullptr;
+    m_end   = nullptr;
+    m_size  = 0;
+  }
+
+  Node*             m_begin;
+  Node*             m_end;
+  size_type         m_size;
+  std::vector<Slot> m_slots;
+  size_type         m_usedSlots; // including tombstones
+  hasher            m_hash;
+  key_equal         m_equal;
+};
+
+template<typename Ty, typename Hash, typename Equal, bool AllowDuplicates>
+void swap(
+  LinkedHashList<Ty, Hash, Equal, AllowDuplicates>& lhs,
+  LinkedHashList<Ty, Hash, Equal, AllowDuplicates>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+#endif // INCG_LINKED_HASH_LIST_HPP
@@ -1,29 +1,238 @@
 #ifndef INCG_LIST_HPP
 #define INCG_LIST_HPP
 #include <cstddef>
+#include <cstdint>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <exception>
 #include <functional>
 #include <initializer_list>
 #include <iterator>
+#include <new>
 #include <ostream>
+#include <ranges>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
+#include <version>
+
+#ifdef __cpp_lib_expected
+#include <expected>
+#endif
+
+#include "allocation_tracking.hpp"
+#include "node_cache.hpp"
+#include "reclaimer.hpp"
+
+// HugePageArena maps its memory with mmap, so lists only take their nodes
+// from one where that is available; elsewhere slabs come from operator new.
+#if __has_include(<sys/mman.h>)
+#define LIST_HAS_HUGE_PAGE_ARENA
+#include "huge_page_arena.hpp"
+#else
+class HugePageArena;
+#endif
+
+// Tags the constructors that take the elements from a range; the same as
+// std::from_range where the standard library has it.
+#ifdef __cpp_lib_containers_ranges
+using std::from_range;
+using std::from_range_t;
+#else
+struct from_range_t {
+  explicit from_range_t() = default;
+};
+
+inline constexpr from_range_t from_range{};
+#endif
+
+// Tags the constructors that build the list on several threads, like
+// std::execution::par does for the standard algorithms; <execution> itself
+// isn't used since libstdc++ implements it on top of TBB, which would have
+// to be linked by every program using List.
+struct parallel_t {
+  explicit parallel_t() = default;
+};
+
+inline constexpr parallel_t parallel{};
+
+// A range whose elements can be added to a container of Ty.
+template<typename Range, typename Ty>
+concept ContainerCompatibleRange
+  = std::ranges::input_range<Range>
+    && std::convertible_to<std::ranges::range_reference_t<Range>, Ty>;
+
+// How front, back and operator[] of a List handle an empty list or an index
+// that is out of bounds.
+enum class ListAccess {
+  // Throw std::out_of_range.
+  checked,
+  // Don't check at all; accessing an element that doesn't exist is
+  // undefined behavior. front and back compile down to a pointer load.
+  unchecked,
+#ifdef __cpp_lib_expected
+  // Return a std::expected holding the ListError instead of the element.
+  expected,
+#endif
+};
+
+enum class ListError { empty, indexOutOfBounds };
+
+// Configures a List, e.g.
+//
+//   List<int, ListConfig{.access = ListAccess::unchecked}> hotList{};
+struct ListConfig {
+  ListAccess access{ListAccess::checked};
+  // Without tracking, the list is a word smaller and splicing a range takes
+  // O(1), but size() counts the elements.
+  bool tracksSize{true};
+  // Carves the nodes out of page-aligned slabs instead of allocating them
+  // one by one, see List::NodeSlab: a copy takes a single allocation and
+  // destroying the list runs no destructors. In exchange, every list that
+  // isn't empty holds at least a 4 KiB page, a single node that is still in
+  // use keeps its whole slab alive and erased nodes are only returned to
+  // their slabs by shrink_to_fit, clear and the destructor.
+  // Requires trivially copyable elements or elements stored out of line.
+  bool usesSlabs{false};
+  // Takes the nodes from a NodeCache of the calling thread, so that nodes
+  // freed on another thread go back to the thread that allocated them in
+  // batches. Can't be combined with usesSlabs.
+  bool cachesNodes{false};
+  // Elements of at least this many bytes are allocated apart from their
+  // nodes, which then only hold the links and a pointer to the element, so
+  // that walking the links doesn't drag the elements through the cache.
+  // 1 stores every element out of line, 0 none.
+  std::size_t outOfLineSize{0};
+};
 
-extern std::unordered_set<void*> newed;
-extern std::unordered_set<void*> deleted;
+// What the accessors of a List return for an element of type Reference.
+template<ListAccess Access, typename Reference>
+struct ListAccessResult {
+  using type = Reference;
+};
 
-template<typename Ty>
+#ifdef __cpp_lib_expected
+template<typename Reference>
+struct ListAccessResult<ListAccess::expected, Reference> {
+  using type = std::expected<
+    std::reference_wrapper<std::remove_reference_t<Reference>>,
+    ListError>;
+};
+#endif
+
+// Everything but the stream output, the functions dealing with the memory
+// layout of the nodes, sort_by_key and release_async is constexpr, so Lists
+// can be used during constant evaluation, e.g. to compute lookup tables
+// that are then copied into a std::array. Like any other allocation made
+// during constant evaluation, a List can't outlive it.
+//
+// Config selects how invalid accesses are handled, whether the size is
+// tracked, where the nodes come from and whether the elements are stored in
+// them; see ListConfig.
+//
+// At runtime the nodes can be carved out of slabs instead of being
+// allocated one by one, see ListConfig::usesSlabs and NodeSlab. The slabs
+// may come from a HugePageArena.
+template<typename Ty, ListConfig Config = ListConfig{}>
 class List {
 public:
   using value_type = Ty;
 
 private:
+  static constexpr bool storesValuesOutOfLine{
+    Config.outOfLineSize != 0 && sizeof(value_type) >= Config.outOfLineSize};
+
+  // What a node holds: its element or, if the elements are stored out of
+  // line, a pointer to it; see valueOf.
+  using StoredValue
+    = std::conditional_t<storesValuesOutOfLine, value_type*, value_type>;
+
   struct Node {
-    value_type value;
-    Node*      prev;
-    Node*      next;
+    StoredValue value;
+    Node*       prev;
+    Node*       next;
+  };
+
+  // A block of pages that nodes are carved out of.
+  // Every page starts with a NodeSlab whose owner points to the one of the
+  // first page, so the slab of a node is found by masking its address.
+  // references counts the nodes of the slab that are in use by any list,
+  // kept in the free list of a list or not handed out yet by the slab
+  // cursor of a list; the last one to drop its reference frees the slab,
+  // returning it to the arena it came from, if any.
+  // Nodes can be spliced between lists on different threads, hence the
+  // atomic.
+  struct NodeSlab {
+    NodeSlab*                owner;
+    std::atomic<std::size_t> references;
+    std::size_t              pageCount;
+    HugePageArena*           arena;
+  };
+
+  static constexpr std::size_t slabPageSize{4096};
+
+  static constexpr std::size_t firstNodeOffset{
+    (sizeof(NodeSlab) + alignof(Node) - 1) / alignof(Node) * alignof(Node)};
+
+  static constexpr std::size_t nodesPerPage{
+    sizeof(Node) < slabPageSize - firstNodeOffset
+      ? (slabPageSize - firstNodeOffset) / sizeof(Node)
+      : 0};
+
+  // The size of the slabs that single insertions take their nodes from
+  // doubles from one page up to this.
+  static constexpr std::size_t maxCursorPages{16};
+
+  // The fewest elements worth copying on a thread of their own.
+  static constexpr std::size_t minParallelSegment{std::size_t{1} << 15};
+
+  // Trivially copyable elements are also trivially destructible, so their
+  // nodes can be freed a slab at a time without running any destructors.
+  static constexpr bool usesSlabs{Config.usesSlabs};
+
+  static_assert(
+    !usesSlabs || std::is_trivially_copyable_v<StoredValue>,
+    "List: only trivially copyable elements, or elements stored out of "
+    "line, can be kept in slabs.");
+  static_assert(
+    !usesSlabs || nodesPerPage >= 8,
+    "List: the elements are too large to be kept in slabs; store them out "
+    "of line.");
+  static_assert(
+    !usesSlabs || !Config.cachesNodes,
+    "List: nodes can't both be cached and kept in slabs.");
+
+  // Where a list takes its nodes from: the nodes that it erased come first,
+  // then the rest of its current slab.
+  // Once the cursor has handed out the last node of its slab it holds no
+  // reference to it anymore, and another list may free the slab; hence the
+  // end of the slab is kept here instead of being read from the slab.
+  // New slabs come from arena unless it's null.
+  struct SlabCursor {
+    Node*          freeNodes{nullptr};
+    Node*          next{nullptr};
+    Node*          pageEnd{nullptr};
+    char*          slabEnd{nullptr};
+    NodeSlab*      slab{nullptr};
+    std::size_t    nextPageCount{1};
+    HugePageArena* arena{nullptr};
+  };
+
+  struct NoSlabCursor {
+  };
+
+  struct SizeCounter {
+    std::size_t count{0};
+  };
+
+  struct NoSizeCounter {
   };
 
 public:
@@ -33,6 +242,12 @@ public:
   using reference       = value_type&;
   using const_reference = const value_type&;
 
+  // What front, back and operator[] return, see ListAccess.
+  using access_result =
+    typename ListAccessResult<Config.access, reference>::type;
+  using const_access_result =
+    typename ListAccessResult<Config.access, const_reference>::type;
+
   class const_iterator;
 
   friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit);
@@ -42,18 +257,18 @@ public:
     friend class List;
 
     using difference_type   = typename List::difference_type;
-    using value_type        = std::remove_cv_t<typename List<Ty>::value_type>;
+    using value_type        = std::remove_cv_t<typename List::value_type>;
     using pointer           = value_type*;
     using reference         = value_type&;
     using iterator_category = std::bidirectional_iterator_tag;
     using iterator_concept  = std::bidirectional_iterator_tag; // C++20
 
-    friend bool operator==(const iterator& lhs, const iterator& rhs)
+    friend constexpr bool operator==(const iterator& lhs, const iterator& rhs)
     {
       return lhs.m_node == rhs.m_node;
     }
 
-    friend bool operator!=(const iterator& lhs, const iterator& rhs)
+    friend constexpr bool operator!=(const iterator& lhs, const iterator& rhs)
     {
       return !(lhs == rhs);
     }
@@ -63,30 +278,34 @@ public:
       return os << "List::iterator{" << it.m_node << '}';
     }
 
-    /* IMPLICIT */ iterator(Node* node) : m_node{node} {}
+    constexpr iterator() : m_node{nullptr} {}
+
+    /* IMPLICIT */ constexpr iterator(Node* node) : m_node{node} {}
 
-    value_type& operator*() const { return m_node->value; }
+    constexpr value_type& operator*() const { return valueOf(m_node); }
 
-    iterator& operator++()
+    constexpr value_type* operator->() const { return &valueOf(m_node); }
+
+    constexpr iterator& operator++()
     {
       m_node = m_node->next;
       return *this;
     }
 
-    iterator operator++(int)
+    constexpr iterator operator++(int)
     {
       iterator it{*this};
       ++(*this);
       return it;
     }
 
-    iterator& operator--()
+    constexpr iterator& operator--()
     {
       m_node = m_node->prev;
       return *this;
     }
 
-    iterator operator--(int)
+    constexpr iterator operator--(int)
     {
       iterator it{*this};
       --(*this);
@@ -102,18 +321,22 @@ public:
     friend class List;
 
     using difference_type   = typename List::difference_type;
-    using value_type        = std::remove_cv_t<typename List<Ty>::value_type>;
+    using value_type        = std::remove_cv_t<typename List::value_type>;
     using pointer           = const value_type*;
     using reference         = const value_type&;
     using iterator_category = std::bidirectional_iterator_tag;
     using iterator_concept  = std::bidirectional_iterator_tag; // C++20
 
-    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    friend constexpr bool operator==(
+      const const_iterator& lhs,
+      const const_iterator& rhs)
     {
       return lhs.m_it == rhs.m_it;
     }
 
-    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    friend constexpr bool operator!=(
+      const const_iterator& lhs,
+      const const_iterator& rhs)
     {
       return !(lhs == rhs);
     }
@@ -124,30 +347,34 @@ public:
                 << reinterpret_cast<const Node* const&>(cit.m_it) << '}';
     }
 
-    /* IMPLICIT */ const_iterator(iterator it) : m_it{it} {}
+    constexpr const_iterator() : m_it{} {}
+
+    /* IMPLICIT */ constexpr const_iterator(iterator it) : m_it{it} {}
 
-    const value_type& operator*() const { return *m_it; }
+    constexpr const value_type& operator*() const { return *m_it; }
 
-    const_iterator& operator++()
+    constexpr const value_type* operator->() const { return &*m_it; }
+
+    constexpr const_iterator& operator++()
     {
       ++m_it;
       return *this;
     }
 
-    const_iterator operator++(int)
+    constexpr const_iterator operator++(int)
     {
       const_iterator it{*this};
       ++(*this);
       return it;
     }
 
-    const_iterator& operator--()
+    constexpr const_iterator& operator--()
     {
       --m_it;
       return *this;
     }
 
-    const_iterator operator--(int)
+    constexpr const_iterator operator--(int)
     {
       const_iterator it{*this};
       --(*this);
@@ -161,6 +388,55 @@ public:
   using reverse_iterator       = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  // The nodes of elements that were taken out of a list by detach_chain,
+  // e.g. to be handed to a list on another thread, which takes them over
+  // with adopt_chain without copying the elements or reallocating the
+  // nodes. Frees the nodes if it's destroyed before that.
+  class node_chain {
+  public:
+    friend class List;
+
+    constexpr node_chain() noexcept
+      : m_first{nullptr}, m_last{nullptr}, m_count{0}
+    {
+    }
+
+    constexpr node_chain(node_chain&& other) noexcept
+      : m_first{std::exchange(other.m_first, nullptr)}
+      , m_last{std::exchange(other.m_last, nullptr)}
+      , m_count{std::exchange(other.m_count, 0)}
+    {
+    }
+
+    constexpr node_chain& operator=(node_chain&& other) noexcept
+    {
+      node_chain chain{std::move(other)};
+      std::swap(m_first, chain.m_first);
+      std::swap(m_last, chain.m_last);
+      std::swap(m_count, chain.m_count);
+      return *this;
+    }
+
+    constexpr ~node_chain()
+    {
+      if (m_first == nullptr) { return; }
+
+      m_last->next = nullptr;
+      freeNodes(m_first, nullptr);
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+      return m_first == nullptr;
+    }
+
+  private:
+    Node* m_first;
+    Node* m_last;
+    // Only counted if the list tracks its size.
+    size_type m_count;
+  };
+
   friend std::ostream& operator<<(std::ostream& os, const this_type& list)
   {
     if (list.empty()) { return os << "List[]"; }
@@ -181,187 +457,378 @@ public:
     return os;
   }
 
-  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator==(const this_type& lhs, const this_type& rhs)
   {
-    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    if constexpr (!Config.tracksSize) {
+      return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+    else if (lhs.size() != rhs.size()) {
+      return false;
+    }
+    else if constexpr (std::is_arithmetic_v<value_type>) {
+      return equalNodes(lhs.m_begin, rhs.m_begin, lhs.size());
+    }
+    else {
+      return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
   }
 
-  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator!=(const this_type& lhs, const this_type& rhs)
   {
     return !(lhs == rhs);
   }
 
-  friend bool operator<(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator<(const this_type& lhs, const this_type& rhs)
   {
-    return std::lexicographical_compare(
-      lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    if constexpr (std::is_arithmetic_v<value_type>) {
+      return lessNodes(lhs.m_begin, lhs.m_end, rhs.m_begin, rhs.m_end);
+    }
+    else {
+      return std::lexicographical_compare(
+        lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
   }
 
-  friend bool operator>(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator>(const this_type& lhs, const this_type& rhs)
   {
     return rhs < lhs;
   }
 
-  friend bool operator<=(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator<=(const this_type& lhs, const this_type& rhs)
   {
     return !(lhs > rhs);
   }
 
-  friend bool operator>=(const this_type& lhs, const this_type& rhs)
+  friend constexpr bool operator>=(const this_type& lhs, const this_type& rhs)
   {
     return !(lhs < rhs);
   }
 
-  List() : m_begin{nullptr}, m_end{nullptr}, m_size{0} { initialize(); }
+  constexpr List() : m_begin{nullptr}, m_end{nullptr}, m_size{}, m_slabs{}
+  {
+    initialize();
+  }
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+  // Takes the nodes from slabs that arena hands out, e.g.
+  //
+  //   HugePageArena                                  arena{};
+  //   List<long long, ListConfig{.usesSlabs = true}> ids{arena};
+  //
+  // Only lists that use slabs, see ListConfig::usesSlabs, take an arena.
+  // Copies of the list use the same arena, which has to outlive the nodes
+  // of all of them.
+  explicit List(HugePageArena& arena) : List{}
+  {
+    static_assert(
+      usesSlabs,
+      "List: only lists that use slabs take their nodes from an arena.");
+    m_slabs.arena = &arena;
+  }
+#endif
 
-  List(const this_type& other) : List{}
+  constexpr List(const this_type& other) : List{}
   {
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        m_slabs.arena = other.m_slabs.arena;
+        copyNodes(other);
+        return;
+      }
+    }
+
     for (const value_type& element : other) { push_back(element); }
   }
 
-  List(std::initializer_list<value_type> initList) : List{}
+  constexpr List(std::initializer_list<value_type> initList) : List{}
   {
     for (const value_type& elementToAdd : initList) { push_back(elementToAdd); }
   }
 
-  this_type& operator=(const this_type& other)
+  // List<int> list(from_range, numbers | std::views::filter(isEven));
+  template<typename Range>
+    requires ContainerCompatibleRange<Range, value_type>
+  constexpr List(from_range_t, Range&& range) : List{}
+  {
+    for (auto&& element : range) { push_back(element); }
+  }
+
+  // Copies the elements of [first, last) on up to threadCount threads,
+  // each of which allocates and links the nodes of one segment, e.g.
+  //
+  //   List<long long> list(parallel, ids.begin(), ids.end());
+  //
+  // The segments are joined in O(threadCount). Ranges that are too small
+  // to be worth starting threads for are copied on the calling thread.
+  // Either all elements are copied or, if an exception is thrown, none.
+  template<std::random_access_iterator It>
+    requires std::convertible_to<std::iter_reference_t<It>, value_type>
+  List(
+    parallel_t,
+    It        first,
+    It        last,
+    size_type threadCount = std::thread::hardware_concurrency())
+    : List{}
+  {
+    appendInParallel(first, last, threadCount);
+  }
+
+  constexpr this_type& operator=(const this_type& other)
   {
     this_type newList{other};
     swap(newList);
     return *this;
   }
 
-  ~List() { destroy(); }
-
-  size_type size() const { return m_size; }
+  constexpr ~List() { destroy(); }
 
-  [[nodiscard]] bool empty() const { return size() == 0; }
-
-  reference front()
+  // O(n) if the list doesn't track its size, see ListConfig.
+  constexpr size_type size() const
   {
-    if (empty()) {
-      throw std::out_of_range{"List::front called on empty list."};
+    if constexpr (Config.tracksSize) { return m_size.count; }
+    else {
+      return static_cast<size_type>(std::distance(begin(), end()));
     }
+  }
+
+  [[nodiscard]] constexpr bool empty() const { return m_begin == m_end; }
 
-    return *begin();
+  constexpr access_result front() { return frontOf<access_result>(*this); }
+
+  constexpr const_access_result front() const
+  {
+    return frontOf<const_access_result>(*this);
   }
 
-  const_reference front() const
+  constexpr access_result back() { return backOf<access_result>(*this); }
+
+  constexpr const_access_result back() const
   {
-    return const_cast<this_type*>(this)->front();
+    return backOf<const_access_result>(*this);
   }
 
-  reference back()
+  constexpr access_result operator[](size_type index)
   {
-    if (empty()) {
-      throw std::out_of_range{"List::back called on empty list."};
-    }
+    return elementOf<access_result>(*this, index);
+  }
 
-    return *rbegin();
+  constexpr const_access_result operator[](size_type index) const
+  {
+    return elementOf<const_access_result>(*this, index);
   }
 
-  const_reference back() const { return const_cast<this_type*>(this)->back(); }
+  constexpr iterator begin() { return iterator{m_begin}; }
 
-  reference operator[](size_type index)
+  constexpr const_iterator begin() const
   {
-    if (index >= size()) {
-      std::string errorMessage{"List::operator[]: index out of bounds: "};
-      errorMessage += std::to_string(index);
-      errorMessage += " is >= size() (";
-      errorMessage += std::to_string(size());
-      errorMessage += ")!";
+    return const_cast<this_type*>(this)->begin();
+  }
 
-      throw std::out_of_range{errorMessage};
-    }
+  constexpr const_iterator cbegin() const { return begin(); }
 
-    iterator it{begin()};
-    std::advance(it, index);
-    return *it;
-  }
+  constexpr iterator end() { return iterator{m_end}; }
 
-  const_reference operator[](size_type index) const
+  constexpr const_iterator end() const
   {
-    return const_cast<this_type*>(this)->operator[](index);
+    return const_cast<this_type*>(this)->end();
   }
 
-  iterator begin() { return iterator{m_begin}; }
+  constexpr const_iterator cend() const { return end(); }
 
-  const_iterator begin() const { return const_cast<this_type*>(this)->begin(); }
+  constexpr reverse_iterator rbegin() { return reverse_iterator{end()}; }
 
-  const_iterator cbegin() const { return begin(); }
+  constexpr const_reverse_iterator rbegin() const
+  {
+    return const_cast<this_type*>(this)->rbegin();
+  }
+
+  constexpr const_reverse_iterator crbegin() const { return rbegin(); }
 
-  iterator end() { return iterator{m_end}; }
+  constexpr reverse_iterator rend() { return reverse_iterator{begin()}; }
 
-  const_iterator end() const { return const_cast<this_type*>(this)->end(); }
+  constexpr const_reverse_iterator rend() const
+  {
+    return const_cast<this_type*>(this)->rend();
+  }
 
-  const_iterator cend() const { return end(); }
+  constexpr const_reverse_iterator crend() const { return rend(); }
 
-  reverse_iterator rbegin() { return reverse_iterator{end()}; }
+  constexpr void sort() { sort(std::less<value_type>{}); }
 
-  const_reverse_iterator rbegin() const
+  // Stable merge sort that only relinks nodes, so iterators keep referring
+  // to the same elements. If binaryComparator throws, the list keeps all of
+  // its elements in an unspecified order.
+  template<typename BinaryComparator>
+  constexpr void sort(BinaryComparator binaryComparator)
   {
-    return const_cast<this_type*>(this)->rbegin();
+    Node* first{m_begin};
+    sortRange(first, size(), binaryComparator);
   }
 
-  const_reverse_iterator crbegin() const { return rbegin(); }
+  // Sorts stably by the keys that keyFunction returns for the elements,
+  // computing every key only once, e.g.
+  //
+  //   records.sort_by_key([](const Record& record) { return record.id; });
+  //
+  // Integral keys compared with std::less are sorted by an LSD radix sort in
+  // linear time; other keys are sorted with keyComparator.
+  // Leaves the list as it was if keyFunction or keyComparator throws.
+  template<typename KeyFunction, typename KeyComparator = std::less<>>
+  void sort_by_key(
+    KeyFunction   keyFunction,
+    KeyComparator keyComparator = KeyComparator{})
+  {
+    using Key = std::remove_cvref_t<
+      std::invoke_result_t<KeyFunction&, const value_type&>>;
+
+    if (size() < 2) { return; }
 
-  reverse_iterator rend() { return reverse_iterator{begin()}; }
+    if constexpr (
+      std::is_integral_v<Key> && !std::is_same_v<Key, bool>
+      && (std::is_same_v<KeyComparator, std::less<>>
+          || std::is_same_v<KeyComparator, std::less<Key>>)) {
+      radixSortByKey(keyFunction);
+    }
+    else {
+      sortByCachedKey(keyFunction, keyComparator);
+    }
+  }
 
-  const_reverse_iterator rend() const
+  // Moves the count smallest elements, or all of them if there are fewer,
+  // to the front of the list in sorted order and returns an iterator to the
+  // element following them. Which of several equal elements are moved is
+  // unspecified; the other elements keep their order.
+  // Takes O(n log count) comparisons and leaves the list as it was if
+  // binaryComparator throws.
+  template<typename BinaryComparator = std::less<value_type>>
+  constexpr iterator partial_sort(
+    size_type        count,
+    BinaryComparator binaryComparator = BinaryComparator{})
   {
-    return const_cast<this_type*>(this)->rend();
+    count = std::min(count, size());
+
+    if (count == 0) { return begin(); }
+
+    // A max-heap of the count smallest nodes seen so far.
+    const auto byValue{[&binaryComparator](Node* lhs, Node* rhs) {
+      return std::invoke(binaryComparator, valueOf(lhs), valueOf(rhs));
+    }};
+    std::vector<Node*> heap{};
+    heap.reserve(count);
+    Node* node{m_begin};
+
+    for (; heap.size() < count; node = node->next) {
+      heap.push_back(node);
+      std::push_heap(heap.begin(), heap.end(), byValue);
+    }
+
+    for (; node != m_end; node = node->next) {
+      if (byValue(node, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), byValue);
+        heap.back() = node;
+        std::push_heap(heap.begin(), heap.end(), byValue);
+      }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), byValue);
+    return iterator{relinkToFront(heap.begin(), heap.end())};
   }
 
-  const_reverse_iterator crend() const { return rend(); }
+  // Relinks the nodes so that the element at index n is the one that would
+  // be there if the list was sorted, no element before it is greater and no
+  // element after it is less, and returns an iterator to it.
+  // The elements after it keep their order.
+  // Takes O(n) comparisons on average and leaves the list as it was if
+  // binaryComparator throws.
+  template<typename BinaryComparator = std::less<value_type>>
+  constexpr iterator nth_element(
+    size_type        n,
+    BinaryComparator binaryComparator = BinaryComparator{})
+  {
+    if (n >= size()) { throwIndexOutOfBounds("nth_element", n, size()); }
 
-  void sort() { sort(std::less<value_type>{}); }
+    std::vector<Node*> nodes{};
+    nodes.reserve(size());
 
-  template<typename BinaryComparator>
-  void sort(BinaryComparator binaryComparator)
+    for (Node* node{m_begin}; node != m_end; node = node->next) {
+      nodes.push_back(node);
+    }
+
+    std::nth_element(
+      nodes.begin(),
+      nodes.begin() + static_cast<difference_type>(n),
+      nodes.end(),
+      [&binaryComparator](Node* lhs, Node* rhs) {
+        return std::invoke(binaryComparator, valueOf(lhs), valueOf(rhs));
+      });
+
+    Node* const nth{nodes[n]};
+    relinkToFront(
+      nodes.begin(), nodes.begin() + static_cast<difference_type>(n + 1));
+    return iterator{nth};
+  }
+
+  // Relinks the elements for which unaryPredicate returns true in front of
+  // the others and returns an iterator to the first of the others.
+  // Relinking keeps the order of the elements within both groups, so this
+  // is the same as stable_partition.
+  // If unaryPredicate throws, the list keeps all of its elements in an
+  // unspecified order.
+  template<typename UnaryPredicate>
+  constexpr iterator partition(UnaryPredicate unaryPredicate)
   {
-    for (Node* node{m_begin}; node->next != m_end; node = node->next) {
-      for (Node* next{node->next}; next != m_end; next = next->next) {
-        if (std::invoke(binaryComparator, next->value, node->value)) {
-          using std::swap;
-          swap(node->value, next->value);
-        }
+    return stable_partition(std::move(unaryPredicate));
+  }
+
+  // Takes O(n) predicate calls.
+  template<typename UnaryPredicate>
+  constexpr iterator stable_partition(UnaryPredicate unaryPredicate)
+  {
+    // The first node for which unaryPredicate returned false.
+    Node* pos{m_end};
+
+    for (Node* node{m_begin}; node != m_end;) {
+      Node* const next{node->next};
+
+      if (!std::invoke(unaryPredicate, std::as_const(valueOf(node)))) {
+        if (pos == m_end) { pos = node; }
+      }
+      else if (pos != m_end) {
+        relinkBefore(pos, node, next);
       }
+
+      node = next;
     }
+
+    return iterator{pos};
   }
 
-  void push_back(const_reference element) { insert(end(), element); }
+  constexpr void push_back(const_reference element) { insert(end(), element); }
 
-  void push_front(const_reference element) { insert(begin(), element); }
+  constexpr void push_front(const_reference element)
+  {
+    insert(begin(), element);
+  }
 
-  void pop_back()
+  constexpr void pop_back()
   {
     if (empty()) { return; }
 
     erase(std::prev(end()));
   }
 
-  void pop_front()
+  constexpr void pop_front()
   {
     if (empty()) { return; }
 
     erase(begin());
   }
 
-  iterator insert(const_iterator pos, const_reference value)
+  constexpr iterator insert(const_iterator pos, const_reference value)
   {
     Node* node{pos.m_it.m_node};
     Node* prev{node->prev};
-    Node* newNode{nullptr};
-
-    try {
-      newNode = new Node{value, prev, node};
-      newed.insert(newNode);
-    }
-    catch (...) {
-      deleted.insert(newNode);
-      delete newNode;
-      throw;
-    }
+    Node* newNode{createNode(value, prev, node)};
 
     if (node == m_begin) { m_begin = newNode; }
     else {
@@ -369,13 +836,152 @@ public:
     }
 
     node->prev = newNode;
-    ++m_size;
+    addToSize(1);
 
     iterator it{newNode};
     return it;
   }
 
-  iterator erase(const_iterator pos)
+  // Inserts the elements of range before pos; either all of them or, if an
+  // exception is thrown, none. The nodes are taken from the list like those
+  // of any other insertion and are chained up before they are linked in.
+  // Returns an iterator to the first inserted element or pos if range is
+  // empty.
+  template<typename Range>
+    requires ContainerCompatibleRange<Range, value_type>
+  constexpr iterator insert_range(const_iterator pos, Range&& range)
+  {
+    return adopt_chain(pos, makeChain(std::forward<Range>(range)));
+  }
+
+  template<typename Range>
+    requires ContainerCompatibleRange<Range, value_type>
+  constexpr void append_range(Range&& range)
+  {
+    insert_range(end(), std::forward<Range>(range));
+  }
+
+  template<typename Range>
+    requires ContainerCompatibleRange<Range, value_type>
+  constexpr void prepend_range(Range&& range)
+  {
+    insert_range(begin(), std::forward<Range>(range));
+  }
+
+  // Merges the elements of range, which should be sorted by comp like the
+  // list, into the list in a single pass: each element is linked in after
+  // the elements that aren't greater than it, searching from where the one
+  // before it went. Elements that are out of order are searched for from
+  // the front instead.
+  // All nodes are allocated before the list is modified, so if that throws
+  // the list is left as it was.
+  template<typename Range, typename BinaryComparator = std::less<>>
+    requires ContainerCompatibleRange<Range, value_type>
+  constexpr void insert_batch_sorted(
+    Range&&          range,
+    BinaryComparator binaryComparator = BinaryComparator{})
+  {
+    if constexpr (std::ranges::sized_range<Range>) {
+      reserveNodes(static_cast<size_type>(std::ranges::size(range)));
+    }
+
+    // The nodes that aren't linked in yet are freed by the chain if the
+    // comparator throws.
+    node_chain        elements{makeChain(std::forward<Range>(range))};
+    Node*             pos{m_begin};
+    const value_type* previous{nullptr};
+
+    while (!elements.empty()) {
+      Node* const       node{elements.m_first};
+      const value_type& value{valueOf(node)};
+
+      if (
+        previous != nullptr
+        && std::invoke(binaryComparator, value, *previous)) {
+        pos = m_begin;
+      }
+
+      while (pos != m_end
+             && !std::invoke(binaryComparator, value, valueOf(pos))) {
+        pos = pos->next;
+      }
+
+      elements.m_first = node->next;
+
+      if constexpr (Config.tracksSize) { --elements.m_count; }
+
+      if (pos == m_begin) { m_begin = node; }
+      else {
+        pos->prev->next = node;
+      }
+
+      node->prev = pos->prev;
+      node->next = pos;
+      pos->prev  = node;
+      addToSize(1);
+      previous = &value;
+    }
+  }
+
+  // Applies insertions, pairs of a position in the list and a value to
+  // insert before it, and erasures, the positions of elements to erase, in
+  // one pass over each. Values inserted before the same position keep
+  // their order; values inserted before an erased element end up where it
+  // was. The positions have to be distinct from each other among the
+  // erasures and refer to this list, not to elements of the batch.
+  // The nodes for the insertions are allocated up front, from a new slab
+  // if the list uses slabs and its current one is too small, so if that
+  // throws the list is left as it was.
+  template<std::ranges::forward_range InsertRange, typename EraseRange>
+    requires ContainerCompatibleRange<EraseRange, const_iterator>
+  constexpr void apply_batch(InsertRange&& insertions, EraseRange&& erasures)
+  {
+    reserveNodes(static_cast<size_type>(std::ranges::distance(insertions)));
+
+    // The new nodes are chained through their next pointers until they are
+    // linked in.
+    Node* first{nullptr};
+    Node* last{nullptr};
+
+    try {
+      for (auto&& [pos, value] : insertions) {
+        Node* const node{createNode(value, nullptr, nullptr)};
+
+        if (first == nullptr) { first = node; }
+        else {
+          last->next = node;
+        }
+
+        last = node;
+      }
+    }
+    catch (...) {
+      while (first != nullptr) {
+        destroyNode(std::exchange(first, first->next));
+      }
+
+      throw;
+    }
+
+    for (auto&& [pos, value] : insertions) {
+      Node* const node{std::exchange(first, first->next)};
+      Node* const next{const_iterator{pos}.m_it.m_node};
+
+      if (next == m_begin) { m_begin = node; }
+      else {
+        next->prev->next = node;
+      }
+
+      node->prev = next->prev;
+      node->next = next;
+      next->prev = node;
+      addToSize(1);
+    }
+
+    for (const_iterator pos : erasures) { erase(pos); }
+  }
+
+  constexpr iterator erase(const_iterator pos)
   {
     Node* node{pos.m_it.m_node};
     Node* next{node->next};
@@ -389,14 +995,13 @@ public:
       next->prev       = node->prev;
     }
 
-    --m_size;
-    deleted.insert(node);
-    delete node;
+    subtractFromSize(1);
+    destroyNode(node);
     return iterator{next};
   }
 
   template<typename UnaryPredicate>
-  size_type remove_if(UnaryPredicate unaryPredicate)
+  constexpr size_type remove_if(UnaryPredicate unaryPredicate)
   {
     size_type elementsRemoved{0};
 
@@ -415,75 +1020,1332 @@ public:
     return elementsRemoved;
   }
 
-  size_type remove(const_reference value)
+  constexpr size_type remove(const_reference value)
   {
     return remove_if(
       [&value](const_reference element) { return element == value; });
   }
 
-  void resize(size_type count, const value_type& value)
+  // Takes all elements out of the list in O(1), leaving it empty.
+  constexpr node_chain detach_chain() noexcept
+  {
+    node_chain chain{};
+
+    if (empty()) { return chain; }
+
+    chain.m_first = m_begin;
+    chain.m_last  = m_end->prev;
+    chain.m_count = Config.tracksSize ? size() : 0;
+    m_begin       = m_end;
+    m_end->prev   = nullptr;
+    subtractFromSize(chain.m_count);
+    return chain;
+  }
+
+  // Links the nodes of chain in front of pos in O(1); chain may have been
+  // detached from a list on another thread.
+  // Returns an iterator to the first adopted element or pos if chain is
+  // empty.
+  constexpr iterator adopt_chain(const_iterator pos, node_chain chain) noexcept
+  {
+    if (chain.empty()) { return pos.m_it; }
+
+    Node* const node{pos.m_it.m_node};
+    Node* const first{std::exchange(chain.m_first, nullptr)};
+    Node* const last{std::exchange(chain.m_last, nullptr)};
+
+    if (node == m_begin) {
+      m_begin     = first;
+      first->prev = nullptr;
+    }
+    else {
+      node->prev->next = first;
+      first->prev      = node->prev;
+    }
+
+    last->next = node;
+    node->prev = last;
+    addToSize(std::exchange(chain.m_count, 0));
+    return iterator{first};
+  }
+
+  // Moves all elements of other in front of pos in O(1).
+  constexpr void splice(const_iterator pos, this_type& other)
+  {
+    if (other.empty()) { return; }
+
+    relink(
+      pos,
+      other,
+      other.begin(),
+      other.end(),
+      Config.tracksSize ? other.size() : 0);
+  }
+
+  // Moves the element at it from other in front of pos in O(1).
+  constexpr void splice(const_iterator pos, this_type& other, const_iterator it)
+  {
+    if (pos == it || pos == std::next(it)) { return; }
+
+    relink(pos, other, it, std::next(it), 1);
+  }
+
+  // Moves the elements in [first, last) from other in front of pos.
+  // Linear in the number of elements moved, which have to be counted,
+  // unless the list doesn't track its size.
+  constexpr void splice(
+    const_iterator pos,
+    this_type&     other,
+    const_iterator first,
+    const_iterator last)
+  {
+    if (first == last) { return; }
+
+    if constexpr (Config.tracksSize) {
+      relink(
+        pos,
+        other,
+        first,
+        last,
+        static_cast<size_type>(std::distance(first, last)));
+    }
+    else {
+      relink(pos, other, first, last, 0);
+    }
+  }
+
+  // Moves the count elements in [first, last) from other in front of pos
+  // in O(1); count has to be std::distance(first, last).
+  constexpr void splice(
+    const_iterator pos,
+    this_type&     other,
+    const_iterator first,
+    const_iterator last,
+    size_type      count)
+  {
+    if (first == last) { return; }
+
+    relink(pos, other, first, last, Config.tracksSize ? count : 0);
+  }
+
+  constexpr void resize(size_type count, const value_type& value)
   {
-    while (count > size()) { push_back(value); }
+    for (size_type current{size()}; current < count; ++current) {
+      push_back(value);
+    }
 
-    while (count < size()) { pop_back(); }
+    for (size_type current{size()}; current > count; --current) {
+      pop_back();
+    }
   }
 
-  void resize(size_type count) { resize(count, value_type{}); }
+  constexpr void resize(size_type count) { resize(count, value_type{}); }
 
-  void clear()
+  constexpr void clear()
   {
     destroy();
     initialize();
   }
 
-  void swap(this_type& other) noexcept
+  // Replaces the elements with those of [first, last), which are copied
+  // on up to threadCount threads, see List(parallel_t, ...). Keeps the
+  // current elements if an exception is thrown.
+  template<std::random_access_iterator It>
+    requires std::convertible_to<std::iter_reference_t<It>, value_type>
+  void assign(
+    parallel_t,
+    It        first,
+    It        last,
+    size_type threadCount = std::thread::hardware_concurrency())
   {
-    std::swap(m_begin, other.m_begin);
-    std::swap(m_end, other.m_end);
-    std::swap(m_size, other.m_size);
+    this_type elements{};
+
+    if constexpr (usesSlabs) { elements.m_slabs.arena = m_slabs.arena; }
+
+    elements.appendInParallel(first, last, threadCount);
+    clear();
+    splice(end(), elements);
   }
 
-private:
-  void initialize()
+  // Empties the list in O(1) and frees the nodes on the thread of
+  // reclaimer, so that destroying a huge list doesn't stall the calling
+  // thread. The destructors of the elements run on that thread too.
+  // Frees the nodes right away if the job can't be posted.
+  void release_async(Reclaimer& reclaimer = Reclaimer::instance())
   {
+    Node* freeNodeList{nullptr};
+
+    if constexpr (usesSlabs) {
+      freeNodeList = std::exchange(m_slabs.freeNodes, nullptr);
+    }
+
+    if (empty() && freeNodeList == nullptr) { return; }
+
+    Node* const first{empty() ? nullptr : m_begin};
+
+    if (first != nullptr) { m_end->prev->next = nullptr; }
+
+    m_begin     = m_end;
+    m_end->prev = nullptr;
+    m_size      = {};
+
+    const auto job{[first, freeNodeList] {
+      freeNodes(first, nullptr);
+
+      if (freeNodeList != nullptr) { releaseNodes(freeNodeList, nullptr); }
+    }};
+
     try {
-      m_begin = new Node{value_type{}, nullptr, nullptr};
-      newed.insert(m_begin);
-      m_end = m_begin;
+      reclaimer.post(job);
     }
     catch (...) {
-      deleted.insert(m_begin);
-      delete m_begin;
-      m_begin = nullptr;
-      throw;
+      job();
     }
   }
 
-  void destroy()
+  // Erases up to budget elements from the front and, once the list is
+  // empty, frees up to budget of the nodes that were kept for reuse.
+  // Bounds the time that tearing down a huge list takes per call, e.g. in a
+  // real-time loop:
+  //
+  //   while (!list.clear_incremental(1024)) { /* wait for the next frame */ }
+  //
+  // Returns whether the list has been cleared completely.
+  constexpr bool clear_incremental(size_type budget)
   {
-    Node* node{m_begin};
+    const size_type elementBudget{budget};
+    Node* const     node{freeNodes(m_begin, m_end, budget)};
 
-    while (node != m_end) {
-      node = node->next;
-      deleted.insert(node->prev);
-      delete node->prev;
+    if (budget != elementBudget) {
+      subtractFromSize(elementBudget - budget);
+      m_begin    = node;
+      node->prev = nullptr;
     }
 
-    deleted.insert(m_end);
-    delete m_end;
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        m_slabs.freeNodes = releaseNodes(m_slabs.freeNodes, nullptr, budget);
+        return empty() && m_slabs.freeNodes == nullptr;
+      }
+    }
 
-    m_begin = nullptr;
-    m_end   = nullptr;
-    m_size  = 0;
+    return empty();
+  }
+
+  // Returns the nodes that were erased and kept for reuse to their slabs.
+  constexpr void shrink_to_fit()
+  {
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        releaseNodes(std::exchange(m_slabs.freeNodes, nullptr), nullptr);
+      }
+    }
+  }
+
+  // Describes how far the nodes are from being laid out in list order.
+  // A gap is a link to a node that doesn't start within a cache line after
+  // the end of the node before it, so that iterating over it can't stream
+  // through memory.
+  struct Layout {
+    size_type nodes;
+    size_type gaps;
+
+    // 0 for a sequential layout, 1 if every link is a gap.
+    double fragmentation() const
+    {
+      return nodes < 2
+               ? 0.0
+               : static_cast<double>(gaps) / static_cast<double>(nodes - 1);
+    }
+  };
+
+  Layout layout() const
+  {
+    constexpr std::uintptr_t maxDistance{sizeof(Node) + 64};
+    Layout                   result{size(), 0};
+
+    if (empty()) { return result; }
+
+    for (const Node* node{m_begin}; node->next != m_end; node = node->next) {
+      const std::uintptr_t address{reinterpret_cast<std::uintptr_t>(node)};
+      const std::uintptr_t nextAddress{
+        reinterpret_cast<std::uintptr_t>(node->next)};
+
+      if (nextAddress <= address || nextAddress - address > maxDistance) {
+        ++result.gaps;
+      }
+    }
+
+    return result;
+  }
+
+  // Moves the elements into new nodes that are allocated in list order, so
+  // that iterating streams through memory again after a lot of insertions
+  // and erasures, and returns the layout from before.
+  // Only lists that use slabs, see ListConfig::usesSlabs, are compacted:
+  // their nodes end up in a single contiguous block. Other lists get their
+  // new nodes wherever the allocator puts them, which may well be where the
+  // nodes freed just before were, so their layout may not improve at all.
+  // Elements stored out of line, see ListConfig::outOfLineSize, are moved
+  // into new allocations in list order as well.
+  // Elements are moved if that can't throw and copied otherwise. If that or
+  // allocating a node throws, the list keeps all of its elements in order,
+  // some of them in new nodes.
+  // Invalidates all iterators but end().
+  Layout defragment()
+  {
+    const Layout before{layout()};
+
+    if (before.gaps != 0) {
+      shrink_to_fit();
+      defragment(begin(), size());
+    }
+
+    return before;
+  }
+
+  // Does the same for at most maxCount elements starting at first, so that
+  // a long list can be defragmented in bounded steps, e.g.
+  //
+  //   for (auto it{list.cbegin()}; it != list.cend();) {
+  //     it = list.defragment(it, 1024);
+  //   }
+  //
+  // Returns an iterator to the first element that wasn't moved. The list
+  // may be modified between the steps as long as that iterator stays valid.
+  // The elements moved by a step follow the ones moved by the previous step
+  // unless elements were inserted in between.
+  // Invalidates the iterators to the moved elements.
+  iterator defragment(const_iterator first, size_type maxCount)
+  {
+    Node* node{first.m_it.m_node};
+
+    if constexpr (usesSlabs) {
+      // A run that starts at the front gets a block for the whole list,
+      // later steps continue where the cursor is.
+      if (node == m_begin && cursorCapacity() < size()) {
+        startSlab((size() + nodesPerPage - 1) / nodesPerPage);
+      }
+
+      NodeSlab*   slab{nullptr};
+      std::size_t count{0};
+
+      for (; maxCount != 0 && node != m_end; --maxCount) {
+        Node* const next{node->next};
+        Node* const newNode{
+          ::new (static_cast<void*>(allocateCursorNode())) Node{*node}};
+
+        try {
+          relocateValue(newNode);
+        }
+        catch (...) {
+          // The new node still shares the element of node, which stays in
+          // the list, so it's only handed back as a free node.
+          newNode->next     = m_slabs.freeNodes;
+          m_slabs.freeNodes = newNode;
+
+          if (count != 0) { releaseReferences(slab, count); }
+
+          throw;
+        }
+
+        replaceNode(node, newNode);
+
+        if (slabOf(node) != slab) {
+          if (count != 0) { releaseReferences(slab, count); }
+
+          slab  = slabOf(node);
+          count = 0;
+        }
+
+        ++count;
+        node = next;
+      }
+
+      if (count != 0) { releaseReferences(slab, count); }
+    }
+    else {
+      for (; maxCount != 0 && node != m_end; --maxCount) {
+        Node* const next{node->next};
+        Node* const newNode{makeNode(
+          std::move_if_noexcept(node->value), node->prev, node->next)};
+        trackAllocation(newNode);
+        replaceNode(node, newNode);
+        trackDeallocation(node);
+        deleteNode(node);
+        relocateValue(newNode);
+        node = next;
+      }
+    }
+
+    return iterator{node};
+  }
+
+  constexpr void swap(this_type& other) noexcept
+  {
+    std::swap(m_begin, other.m_begin);
+    std::swap(m_end, other.m_end);
+    std::swap(m_size, other.m_size);
+    std::swap(m_slabs, other.m_slabs);
+  }
+
+private:
+  // The accessors are shared by the const and non-const overloads; Self is
+  // this_type or const this_type.
+  template<typename Result, typename Self>
+  static constexpr Result frontOf(Self& self)
+  {
+    if constexpr (Config.access == ListAccess::checked) {
+      if (self.empty()) {
+        throw std::out_of_range{"List::front called on empty list."};
+      }
+    }
+#ifdef __cpp_lib_expected
+    else if constexpr (Config.access == ListAccess::expected) {
+      if (self.empty()) { return std::unexpected{ListError::empty}; }
+    }
+#endif
+
+    return valueOf(self.m_begin);
+  }
+
+  template<typename Result, typename Self>
+  static constexpr Result backOf(Self& self)
+  {
+    if constexpr (Config.access == ListAccess::checked) {
+      if (self.empty()) {
+        throw std::out_of_range{"List::back called on empty list."};
+      }
+    }
+#ifdef __cpp_lib_expected
+    else if constexpr (Config.access == ListAccess::expected) {
+      if (self.empty()) { return std::unexpected{ListError::empty}; }
+    }
+#endif
+
+    return valueOf(self.m_end->prev);
+  }
+
+  template<typename Result, typename Self>
+  static constexpr Result elementOf(Self& self, size_type index)
+  {
+    Node* node{self.m_begin};
+
+    if constexpr (Config.access == ListAccess::unchecked) {
+      for (; index != 0; --index) { node = node->next; }
+
+      return valueOf(node);
+    }
+    else {
+      // Walks the list only once, even if it doesn't track its size.
+      const size_type requested{index};
+
+      for (; index != 0 && node != self.m_end; --index) { node = node->next; }
+
+      if (node == self.m_end) {
+#ifdef __cpp_lib_expected
+        if constexpr (Config.access == ListAccess::expected) {
+          return std::unexpected{ListError::indexOutOfBounds};
+        }
+#endif
+
+        throwIndexOutOfBounds("operator[]", requested, self.size());
+      }
+
+      return valueOf(node);
+    }
+  }
+
+  constexpr void addToSize([[maybe_unused]] size_type count)
+  {
+    if constexpr (Config.tracksSize) { m_size.count += count; }
+  }
+
+  constexpr void subtractFromSize([[maybe_unused]] size_type count)
+  {
+    if constexpr (Config.tracksSize) { m_size.count -= count; }
+  }
+
+  // Throws the std::out_of_range of the member function called function
+  // for an index that is >= size.
+  [[noreturn]] static void throwIndexOutOfBounds(
+    std::string_view function,
+    size_type        index,
+    size_type        size)
+  {
+    std::string errorMessage{"List::"};
+    errorMessage += function;
+    errorMessage += ": index out of bounds: ";
+    errorMessage += std::to_string(index);
+    errorMessage += " is >= size() (";
+    errorMessage += std::to_string(size);
+    errorMessage += ")!";
+
+    throw std::out_of_range{errorMessage};
+  }
+
+  constexpr void relink(
+    const_iterator pos,
+    this_type&     other,
+    const_iterator first,
+    const_iterator last,
+    size_type      count)
+  {
+    Node* firstNode{first.m_it.m_node};
+    Node* lastNode{last.m_it.m_node};
+    Node* lastIncluded{lastNode->prev};
+
+    if (firstNode == other.m_begin) {
+      other.m_begin  = lastNode;
+      lastNode->prev = nullptr;
+    }
+    else {
+      firstNode->prev->next = lastNode;
+      lastNode->prev        = firstNode->prev;
+    }
+
+    other.subtractFromSize(count);
+
+    Node* node{pos.m_it.m_node};
+
+    if (node == m_begin) {
+      m_begin         = firstNode;
+      firstNode->prev = nullptr;
+    }
+    else {
+      node->prev->next = firstNode;
+      firstNode->prev  = node->prev;
+    }
+
+    lastIncluded->next = node;
+    node->prev         = lastIncluded;
+    addToSize(count);
+  }
+
+  // Moves the nodes from first up to but excluding last in front of pos.
+  constexpr void relinkBefore(Node* pos, Node* first, Node* last)
+  {
+    Node* const lastIncluded{last->prev};
+
+    if (first == m_begin) { m_begin = last; }
+    else {
+      first->prev->next = last;
+    }
+
+    last->prev = first->prev;
+
+    if (pos == m_begin) { m_begin = first; }
+    else {
+      pos->prev->next = first;
+    }
+
+    first->prev        = pos->prev;
+    lastIncluded->next = pos;
+    pos->prev          = lastIncluded;
+  }
+
+  // Sorts the count nodes starting at first, stores the new first node in
+  // first and returns the node following the sorted range.
+  template<typename BinaryComparator>
+  constexpr Node* sortRange(
+    Node*&            first,
+    size_type         count,
+    BinaryComparator& binaryComparator)
+  {
+    if (count == 0) { return first; }
+
+    if (count == 1) { return first->next; }
+
+    Node*       mid{sortRange(first, count / 2, binaryComparator)};
+    Node* const last{sortRange(mid, count - count / 2, binaryComparator)};
+    Node*       it{first};
+
+    if (std::invoke(binaryComparator, valueOf(mid), valueOf(first))) {
+      first = mid;
+    }
+
+    while (it != mid && mid != last) {
+      if (std::invoke(binaryComparator, valueOf(mid), valueOf(it))) {
+        Node* runEnd{mid->next};
+
+        while (
+          runEnd != last
+          && std::invoke(binaryComparator, valueOf(runEnd), valueOf(it))) {
+          runEnd = runEnd->next;
+        }
+
+        relinkBefore(it, mid, runEnd);
+        mid = runEnd;
+      }
+      else {
+        it = it->next;
+      }
+    }
+
+    return last;
+  }
+
+  // Moves the nodes from first to last to the front of the list in that
+  // order and returns the node following them.
+  template<typename NodeIterator>
+  constexpr Node* relinkToFront(NodeIterator first, NodeIterator last)
+  {
+    Node* pos{m_begin};
+
+    for (; first != last; ++first) {
+      Node* const node{*first};
+
+      if (node == pos) { pos = pos->next; }
+      else {
+        relinkBefore(pos, node, node->next);
+      }
+    }
+
+    return pos;
+  }
+
+  // Links the nodes in the order given by nodeAt(0) to nodeAt(size() - 1).
+  template<typename NodeAt>
+  void relinkInOrder(NodeAt nodeAt)
+  {
+    Node*           prev{nullptr};
+    const size_type count{size()};
+
+    for (size_type i{0}; i < count; ++i) {
+      Node* const node{nodeAt(i)};
+      node->prev = prev;
+
+      if (prev == nullptr) { m_begin = node; }
+      else {
+        prev->next = node;
+      }
+
+      prev = node;
+    }
+
+    prev->next  = m_end;
+    m_end->prev = prev;
+  }
+
+  template<typename KeyFunction, typename KeyComparator>
+  void sortByCachedKey(KeyFunction& keyFunction, KeyComparator& keyComparator)
+  {
+    using Result = std::invoke_result_t<KeyFunction&, const value_type&>;
+
+    // Keys that keyFunction returns by reference, e.g. a member of the
+    // element, aren't copied.
+    constexpr bool byReference{std::is_lvalue_reference_v<Result>};
+    using Key = std::conditional_t<
+      byReference,
+      const std::remove_reference_t<Result>*,
+      std::remove_cvref_t<Result>>;
+
+    struct KeyedNode {
+      Key   key;
+      Node* node;
+    };
+
+    std::vector<KeyedNode> keyedNodes{};
+    keyedNodes.reserve(size());
+
+    for (Node* node{m_begin}; node != m_end; node = node->next) {
+      const value_type& value{valueOf(node)};
+
+      if constexpr (byReference) {
+        keyedNodes.push_back(KeyedNode{&std::invoke(keyFunction, value), node});
+      }
+      else {
+        keyedNodes.push_back(KeyedNode{std::invoke(keyFunction, value), node});
+      }
+    }
+
+    std::stable_sort(
+      keyedNodes.begin(),
+      keyedNodes.end(),
+      [&keyComparator](const KeyedNode& lhs, const KeyedNode& rhs) {
+        if constexpr (byReference) {
+          return std::invoke(keyComparator, *lhs.key, *rhs.key);
+        }
+        else {
+          return std::invoke(keyComparator, lhs.key, rhs.key);
+        }
+      });
+
+    relinkInOrder([&keyedNodes](size_type i) { return keyedNodes[i].node; });
+  }
+
+  // Sorts the nodes by their keys eight bits at a time, starting with the
+  // least significant ones. The keys are computed once into an array that
+  // is sorted instead of the list: relinking the nodes into buckets on every
+  // pass would chase a pointer per node and pass.
+  template<typename KeyFunction>
+  void radixSortByKey(KeyFunction& keyFunction)
+  {
+    using Key = std::remove_cvref_t<
+      std::invoke_result_t<KeyFunction&, const value_type&>>;
+    using UnsignedKey = std::make_unsigned_t<Key>;
+
+    struct KeyedNode {
+      UnsignedKey key;
+      Node*       node;
+    };
+
+    constexpr std::size_t digitBits{8};
+    constexpr std::size_t bucketCount{std::size_t{1} << digitBits};
+    constexpr std::size_t digitCount{sizeof(Key)};
+
+    // Flipping the sign bit orders negative keys before positive ones.
+    constexpr UnsignedKey signBit{
+      std::is_signed_v<Key>
+        ? static_cast<UnsignedKey>(UnsignedKey{1} << (sizeof(Key) * 8 - 1))
+        : UnsignedKey{0}};
+
+    const size_type        count{size()};
+    std::vector<KeyedNode> keyedNodes(count);
+    std::vector<KeyedNode> buffer(count);
+    std::array<std::array<size_type, bucketCount>, digitCount> histograms{};
+    size_type                                                   i{0};
+
+    for (Node* node{m_begin}; node != m_end; node = node->next, ++i) {
+      const UnsignedKey key{static_cast<UnsignedKey>(
+        static_cast<UnsignedKey>(
+          std::invoke(keyFunction, std::as_const(valueOf(node))))
+        ^ signBit)};
+      keyedNodes[i] = KeyedNode{key, node};
+
+      for (std::size_t digit{0}; digit < digitCount; ++digit) {
+        ++histograms[digit][(key >> (digit * digitBits)) & (bucketCount - 1)];
+      }
+    }
+
+    for (std::size_t digit{0}; digit < digitCount; ++digit) {
+      std::array<size_type, bucketCount>& histogram{histograms[digit]};
+
+      // Skips the digits that all keys have in common.
+      if (std::find(histogram.begin(), histogram.end(), count)
+          != histogram.end()) {
+        continue;
+      }
+
+      size_type offset{0};
+
+      for (size_type& count : histogram) {
+        offset += std::exchange(count, offset);
+      }
+
+      for (const KeyedNode& keyedNode : keyedNodes) {
+        const std::size_t bucket{
+          (keyedNode.key >> (digit * digitBits)) & (bucketCount - 1)};
+        buffer[histogram[bucket]++] = keyedNode;
+      }
+
+      keyedNodes.swap(buffer);
+    }
+
+    relinkInOrder([&keyedNodes](size_type i) { return keyedNodes[i].node; });
+  }
+
+  // Puts newNode, which already has node's links, in place of node.
+  void replaceNode(Node* node, Node* newNode)
+  {
+    if (node == m_begin) { m_begin = newNode; }
+    else {
+      node->prev->next = newNode;
+    }
+
+    node->next->prev = newNode;
+  }
+
+  static constexpr value_type& valueOf(Node* node)
+  {
+    if constexpr (storesValuesOutOfLine) { return *node->value; }
+    else {
+      return node->value;
+    }
+  }
+
+  static constexpr const value_type& valueOf(const Node* node)
+  {
+    if constexpr (storesValuesOutOfLine) { return *node->value; }
+    else {
+      return node->value;
+    }
+  }
+
+  constexpr Node* createNode(const_reference value, Node* prev, Node* next)
+  {
+    if constexpr (storesValuesOutOfLine) {
+      value_type* const stored{storeValue(value)};
+
+      try {
+        return allocateNode(stored, prev, next);
+      }
+      catch (...) {
+        freeValue(stored);
+        throw;
+      }
+    }
+    else {
+      return allocateNode(value, prev, next);
+    }
+  }
+
+  template<typename Value>
+  static constexpr value_type* storeValue(Value&& value)
+  {
+    value_type* stored{nullptr};
+
+    try {
+      stored = new value_type(std::forward<Value>(value));
+      trackAllocation(stored);
+    }
+    catch (...) {
+      trackDeallocation(stored);
+      delete stored;
+      throw;
+    }
+
+    return stored;
+  }
+
+  static constexpr void freeValue(value_type* stored)
+  {
+    trackDeallocation(stored);
+    delete stored;
+  }
+
+  // Moves the element of node into a new allocation if it is stored out of
+  // line. Leaves node as it was if that throws.
+  static constexpr void relocateValue(Node* node)
+  {
+    if constexpr (storesValuesOutOfLine) {
+      value_type* const old{node->value};
+      node->value = storeValue(std::move_if_noexcept(*old));
+      freeValue(old);
+    }
+  }
+
+  // Frees the element of node if it is stored out of line.
+  static constexpr void destroyValue(Node* node)
+  {
+    if constexpr (storesValuesOutOfLine) { freeValue(node->value); }
+  }
+
+  // Allocates a node holding stored, which is what the node holds as its
+  // value, see StoredValue.
+  template<typename Stored>
+  constexpr Node* allocateNode(Stored&& stored, Node* prev, Node* next)
+  {
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        return ::new (static_cast<void*>(allocateSlabNode()))
+          Node{std::forward<Stored>(stored), prev, next};
+      }
+    }
+
+    Node* newNode{nullptr};
+
+    try {
+      newNode = makeNode(std::forward<Stored>(stored), prev, next);
+      trackAllocation(newNode);
+    }
+    catch (...) {
+      trackDeallocation(newNode);
+      deleteNode(newNode);
+      throw;
+    }
+
+    return newNode;
+  }
+
+  // Allocates a node that doesn't come from a slab.
+  template<typename... Args>
+  static constexpr Node* makeNode(Args&&... args)
+  {
+    if constexpr (Config.cachesNodes) {
+      if (!std::is_constant_evaluated()) {
+        void* const block{NodeCache<sizeof(Node), alignof(Node)>::allocate()};
+
+        try {
+          return ::new (block) Node{std::forward<Args>(args)...};
+        }
+        catch (...) {
+          NodeCache<sizeof(Node), alignof(Node)>::deallocate(block);
+          throw;
+        }
+      }
+    }
+
+    return new Node{std::forward<Args>(args)...};
+  }
+
+  static constexpr void deleteNode(Node* node)
+  {
+    if constexpr (Config.cachesNodes) {
+      if (!std::is_constant_evaluated()) {
+        if (node != nullptr) {
+          node->~Node();
+          NodeCache<sizeof(Node), alignof(Node)>::deallocate(node);
+        }
+
+        return;
+      }
+    }
+
+    delete node;
+  }
+
+  constexpr void destroyNode(Node* node)
+  {
+    destroyValue(node);
+
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        node->next        = m_slabs.freeNodes;
+        m_slabs.freeNodes = node;
+        return;
+      }
+    }
+
+    trackDeallocation(node);
+    deleteNode(node);
+  }
+
+  static NodeSlab* slabOf(const Node* node)
+  {
+    return reinterpret_cast<NodeSlab*>(pageOf(node))->owner;
+  }
+
+  static char* pageOf(const Node* node)
+  {
+    const std::uintptr_t address{reinterpret_cast<std::uintptr_t>(node)};
+    return reinterpret_cast<char*>(address & ~(slabPageSize - 1));
+  }
+
+  static Node* firstNodeOfPage(char* page)
+  {
+    return reinterpret_cast<Node*>(page + firstNodeOffset);
+  }
+
+  static char* endOf(NodeSlab* slab)
+  {
+    return reinterpret_cast<char*>(slab) + slab->pageCount * slabPageSize;
+  }
+
+  // Makes a new slab of pageCount pages the current one of the cursor.
+  void startSlab(std::size_t pageCount)
+  {
+    releaseCursor();
+
+    const std::size_t bytes{pageCount * slabPageSize};
+    char*             memory{nullptr};
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+    if (m_slabs.arena != nullptr) {
+      memory = static_cast<char*>(m_slabs.arena->allocate(bytes, slabPageSize));
+    }
+#endif
+
+    if (memory == nullptr) {
+      memory = static_cast<char*>(
+        ::operator new(bytes, std::align_val_t{slabPageSize}));
+    }
+
+    NodeSlab* slab{reinterpret_cast<NodeSlab*>(memory)};
+
+    for (std::size_t page{0}; page < pageCount; ++page) {
+      ::new (static_cast<void*>(memory + page * slabPageSize))
+        NodeSlab{slab, {pageCount * nodesPerPage}, pageCount, m_slabs.arena};
+    }
+
+    trackAllocation(slab);
+    m_slabs.slab    = slab;
+    m_slabs.slabEnd = endOf(slab);
+    m_slabs.next    = firstNodeOfPage(memory);
+    m_slabs.pageEnd = m_slabs.next + nodesPerPage;
+  }
+
+  Node* allocateSlabNode()
+  {
+    if (m_slabs.freeNodes != nullptr) {
+      return std::exchange(m_slabs.freeNodes, m_slabs.freeNodes->next);
+    }
+
+    return allocateCursorNode();
+  }
+
+  // Hands out the next node of the current slab, which follows the one
+  // handed out before unless a new slab had to be started.
+  Node* allocateCursorNode()
+  {
+    if (m_slabs.next == m_slabs.pageEnd) {
+      char* const nextPage{
+        m_slabs.slab == nullptr ? nullptr
+                                : pageOf(m_slabs.pageEnd - 1) + slabPageSize};
+
+      if (nextPage != nullptr && nextPage != m_slabs.slabEnd) {
+        m_slabs.next    = firstNodeOfPage(nextPage);
+        m_slabs.pageEnd = m_slabs.next + nodesPerPage;
+      }
+      else {
+        startSlab(m_slabs.nextPageCount);
+        m_slabs.nextPageCount
+          = std::min(2 * m_slabs.nextPageCount, maxCursorPages);
+      }
+    }
+
+    return m_slabs.next++;
+  }
+
+  static void releaseReferences(NodeSlab* slab, std::size_t count)
+  {
+    if (slab->references.fetch_sub(count, std::memory_order_acq_rel) == count) {
+      const std::size_t bytes{slab->pageCount * slabPageSize};
+      trackDeallocation(slab);
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+      if (slab->arena != nullptr) {
+        slab->arena->deallocate(slab, bytes, slabPageSize);
+        return;
+      }
+#endif
+
+      ::operator delete(slab, bytes, std::align_val_t{slabPageSize});
+    }
+  }
+
+  // The number of nodes that the cursor hasn't handed out yet.
+  std::size_t cursorCapacity() const
+  {
+    if (m_slabs.slab == nullptr) { return 0; }
+
+    const char* const nextPage{pageOf(m_slabs.pageEnd - 1) + slabPageSize};
+    return static_cast<std::size_t>(m_slabs.pageEnd - m_slabs.next)
+           + static_cast<std::size_t>(m_slabs.slabEnd - nextPage)
+               / slabPageSize * nodesPerPage;
+  }
+
+  // Drops the references of the nodes that the cursor hasn't handed out.
+  void releaseCursor()
+  {
+    const std::size_t unused{cursorCapacity()};
+    NodeSlab*         slab{std::exchange(m_slabs.slab, nullptr)};
+
+    if (slab == nullptr) { return; }
+
+    m_slabs.next    = nullptr;
+    m_slabs.pageEnd = nullptr;
+    m_slabs.slabEnd = nullptr;
+
+    if (unused != 0) { releaseReferences(slab, unused); }
+  }
+
+  // Drops the references of the nodes from node up to but excluding end,
+  // one atomic operation per run of nodes from the same slab.
+  static void releaseNodes(Node* node, const Node* end)
+  {
+    size_type unlimited{static_cast<size_type>(-1)};
+    releaseNodes(node, end, unlimited);
+  }
+
+  // Stops after budget nodes, which is reduced by the number of nodes
+  // released; returns the first node that wasn't released.
+  static Node* releaseNodes(Node* node, const Node* end, size_type& budget)
+  {
+    NodeSlab*   slab{nullptr};
+    std::size_t count{0};
+
+    for (; node != end && budget != 0; --budget) {
+      NodeSlab* const nodeSlab{slabOf(node)};
+
+      if (nodeSlab != slab) {
+        if (count != 0) { releaseReferences(slab, count); }
+
+        slab  = nodeSlab;
+        count = 0;
+      }
+
+      ++count;
+      node = node->next;
+    }
+
+    if (count != 0) { releaseReferences(slab, count); }
+
+    return node;
+  }
+
+  // Copies the elements of other into the nodes of a single new slab that
+  // fits all of them, linking them as they are written; the list has to be
+  // empty. Trivially copyable elements are copied by plain stores, without
+  // a call per node; elements stored out of line are copied one by one.
+  void copyNodes(const this_type& other)
+  {
+    if (other.empty()) { return; }
+
+    const size_type count{other.size()};
+    startSlab((count + nodesPerPage - 1) / nodesPerPage);
+
+    Node*       prev{nullptr};
+    const Node* source{other.m_begin};
+
+    for (size_type i{0}; i < count; ++i, source = source->next) {
+      Node* node{nullptr};
+
+      if constexpr (storesValuesOutOfLine) {
+        node = createNode(valueOf(source), prev, m_end);
+      }
+      else {
+        node = ::new (static_cast<void*>(allocateCursorNode()))
+          Node{source->value, prev, m_end};
+      }
+
+      if (prev == nullptr) { m_begin = node; }
+      else {
+        prev->next = node;
+      }
+
+      prev = node;
+    }
+
+    m_end->prev = prev;
+    addToSize(count);
+  }
+
+  // Allocates nodes holding the elements of range from the list and chains
+  // them up without linking them into it. If an exception is thrown, the
+  // chain frees the nodes allocated so far.
+  template<typename Range>
+  constexpr node_chain makeChain(Range&& range)
+  {
+    node_chain chain{};
+
+    for (auto&& element : range) {
+      Node* const node{createNode(element, chain.m_last, nullptr)};
+
+      if (chain.m_first == nullptr) { chain.m_first = node; }
+      else {
+        chain.m_last->next = node;
+      }
+
+      chain.m_last = node;
+
+      if constexpr (Config.tracksSize) { ++chain.m_count; }
+    }
+
+    return chain;
+  }
+
+  // Builds a list of the elements of each segment of [first, last) on a
+  // thread of its own, so that the threads neither share a slab cursor nor
+  // contend for the same nodes, and splices them onto the end in order.
+  template<typename It>
+  void appendInParallel(It first, It last, size_type threadCount)
+  {
+    const size_type elementCount{static_cast<size_type>(last - first)};
+    const size_type segmentCount{std::clamp<size_type>(
+      elementCount / minParallelSegment,
+      1,
+      std::max<size_type>(threadCount, 1))};
+    const size_type segmentSize{
+      (elementCount + segmentCount - 1) / segmentCount};
+    std::vector<this_type>          segments(segmentCount);
+    std::vector<std::exception_ptr> exceptions(segmentCount);
+
+    const auto buildSegment{[&](size_type index) {
+      const auto begin{first + static_cast<std::iter_difference_t<It>>(
+                         std::min(index * segmentSize, elementCount))};
+      const auto end{first + static_cast<std::iter_difference_t<It>>(
+                       std::min((index + 1) * segmentSize, elementCount))};
+
+      try {
+        if constexpr (usesSlabs) {
+          segments[index].m_slabs.arena = m_slabs.arena;
+        }
+
+        for (auto it{begin}; it != end; ++it) {
+          segments[index].push_back(*it);
+        }
+      }
+      catch (...) {
+        exceptions[index] = std::current_exception();
+      }
+    }};
+
+    {
+      std::vector<std::jthread> threads{};
+      threads.reserve(segmentCount - 1);
+
+      // Joining the threads that did start is left to their destructors
+      // if starting another one fails.
+      for (size_type index{1}; index < segmentCount; ++index) {
+        threads.emplace_back(buildSegment, index);
+      }
+
+      buildSegment(0);
+    }
+
+    for (const std::exception_ptr& exception : exceptions) {
+      if (exception) { std::rethrow_exception(exception); }
+    }
+
+    for (this_type& segment : segments) { splice(end(), segment); }
+  }
+
+  // Makes the next count nodes of the list come from the slab of its
+  // cursor, if it uses slabs, unless there are freed nodes to reuse first.
+  // The cursor grows as it would when running out of nodes, but by no more
+  // than maxCursorPages pages at a time.
+  constexpr void reserveNodes(size_type count)
+  {
+    if constexpr (usesSlabs) {
+      if (
+        !std::is_constant_evaluated() && m_slabs.freeNodes == nullptr
+        && cursorCapacity() < count) {
+        startSlab(std::clamp(
+          (count + nodesPerPage - 1) / nodesPerPage,
+          m_slabs.nextPageCount,
+          maxCursorPages));
+        m_slabs.nextPageCount
+          = std::min(2 * m_slabs.nextPageCount, maxCursorPages);
+      }
+    }
+  }
+
+  constexpr void initialize()
+  {
+    try {
+      m_begin = new Node{StoredValue{}, nullptr, nullptr};
+      trackAllocation(m_begin);
+      m_end = m_begin;
+    }
+    catch (...) {
+      trackDeallocation(m_begin);
+      delete m_begin;
+      m_begin = nullptr;
+      throw;
+    }
+  }
+
+  constexpr void destroy()
+  {
+    freeNodes(m_begin, m_end);
+
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        releaseNodes(std::exchange(m_slabs.freeNodes, nullptr), nullptr);
+        releaseCursor();
+      }
+    }
+
+    trackDeallocation(m_end);
+    delete m_end;
+
+    m_begin = nullptr;
+    m_end   = nullptr;
+    m_size  = {};
+  }
+
+  // Frees the nodes from node up to but excluding end.
+  static constexpr void freeNodes(Node* node, const Node* end)
+  {
+    size_type unlimited{static_cast<size_type>(-1)};
+    freeNodes(node, end, unlimited);
+  }
+
+  // Stops after budget nodes, which is reduced by the number of nodes freed;
+  // returns the first node that wasn't freed.
+  static constexpr Node* freeNodes(
+    Node*       node,
+    const Node* end,
+    size_type&  budget)
+  {
+    if constexpr (usesSlabs) {
+      if (!std::is_constant_evaluated()) {
+        if constexpr (storesValuesOutOfLine) {
+          size_type remaining{budget};
+
+          for (Node* it{node}; it != end && remaining != 0; --remaining) {
+            destroyValue(it);
+            it = it->next;
+          }
+        }
+
+        return releaseNodes(node, end, budget);
+      }
+    }
+
+    for (; node != end && budget != 0; --budget) {
+      Node* const next{node->next};
+      destroyValue(node);
+      trackDeallocation(node);
+      deleteNode(node);
+      node = next;
+    }
+
+    return node;
+  }
+
+  // Compares count values of the chains starting at lhs and rhs, four at a
+  // time so that the comparisons don't have to wait for each other.
+  static constexpr bool equalNodes(
+    const Node* lhs,
+    const Node* rhs,
+    size_type   count)
+  {
+    for (; count >= 4; count -= 4) {
+      const Node* lhs1{lhs->next};
+      const Node* rhs1{rhs->next};
+      const Node* lhs2{lhs1->next};
+      const Node* rhs2{rhs1->next};
+      const Node* lhs3{lhs2->next};
+      const Node* rhs3{rhs2->next};
+
+      if (
+        (valueOf(lhs) != valueOf(rhs)) | (valueOf(lhs1) != valueOf(rhs1))
+        | (valueOf(lhs2) != valueOf(rhs2))
+        | (valueOf(lhs3) != valueOf(rhs3))) {
+        return false;
+      }
+
+      lhs = lhs3->next;
+      rhs = rhs3->next;
+    }
+
+    for (; count > 0; --count) {
+      if (valueOf(lhs) != valueOf(rhs)) { return false; }
+
+      lhs = lhs->next;
+      rhs = rhs->next;
+    }
+
+    return true;
+  }
+
+  static constexpr bool lessNodes(
+    const Node* lhs,
+    const Node* lhsEnd,
+    const Node* rhs,
+    const Node* rhsEnd)
+  {
+    for (; lhs != lhsEnd && rhs != rhsEnd; lhs = lhs->next, rhs = rhs->next) {
+      if (valueOf(lhs) < valueOf(rhs)) { return true; }
+
+      if (valueOf(rhs) < valueOf(lhs)) { return false; }
+    }
+
+    return lhs == lhsEnd && rhs != rhsEnd;
   }
 
-  Node*     m_begin;
-  Node*     m_end;
-  size_type m_size;
+  Node* m_begin;
+  Node* m_end;
+  [[no_unique_address]] std::
+    conditional_t<Config.tracksSize, SizeCounter, NoSizeCounter> m_size;
+  [[no_unique_address]] std::
+    conditional_t<usesSlabs, SlabCursor, NoSlabCursor> m_slabs;
 };
 
-template<typename Ty>
-void swap(List<Ty>& lhs, List<Ty>& rhs) noexcept
+template<typename Ty, ListConfig Config>
+constexpr void swap(List<Ty, Config>& lhs, List<Ty, Config>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
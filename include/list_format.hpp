@@ -0,0 +1,129 @@
+#ifndef INCG_LIST_FORMAT_HPP
+#define INCG_LIST_FORMAT_HPP
+#include <cstddef>
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <version>
+
+#ifdef __cpp_lib_format
+#include <format>
+#endif
+
+#include "list.hpp"
+
+template<typename Ty>
+inline constexpr bool isCharacterType{
+  std::is_same_v<Ty, char> || std::is_same_v<Ty, signed char>
+  || std::is_same_v<Ty, unsigned char> || std::is_same_v<Ty, wchar_t>
+  || std::is_same_v<Ty, char8_t> || std::is_same_v<Ty, char16_t>
+  || std::is_same_v<Ty, char32_t>};
+
+// Arithmetic types that operator<< prints as plain numbers.
+// Streams print characters as characters and bools as 0 / 1, so those
+// take the regular path.
+template<typename Ty>
+inline constexpr bool hasToCharsFastPath{
+  std::is_floating_point_v<Ty>
+  || (std::is_integral_v<Ty> && !std::is_same_v<Ty, bool>
+      && !isCharacterType<Ty>)};
+
+// Appends value to buffer exactly like a default constructed std::ostream
+// would print it: floating point values use %g with a precision of 6.
+template<typename Ty>
+void appendStreamChars(std::string& buffer, Ty value)
+{
+  char chars[64];
+  std::to_chars_result result{};
+
+  if constexpr (std::is_floating_point_v<Ty>) {
+    result = std::to_chars(
+      std::begin(chars), std::end(chars), value, std::chars_format::general, 6);
+  }
+  else {
+    result = std::to_chars(std::begin(chars), std::end(chars), value);
+  }
+
+  buffer.append(chars, result.ptr);
+}
+
+// Appends the text that operator<< prints for list to buffer.
+// Callers dumping many lists should reuse the same buffer so that its
+// capacity is only allocated once.
+template<typename Ty, ListConfig Config>
+void appendTo(std::string& buffer, const List<Ty, Config>& list)
+{
+  if constexpr (hasToCharsFastPath<Ty>) {
+    using namespace std::string_view_literals;
+
+    buffer.reserve(buffer.size() + 6 + list.size() * 8);
+    buffer += "List["sv;
+
+    bool isFirst{true};
+
+    for (Ty element : list) {
+      if (!isFirst) { buffer += ", "sv; }
+
+      appendStreamChars(buffer, element);
+      isFirst = false;
+    }
+
+    buffer += ']';
+  }
+  else {
+    std::ostringstream oss{};
+    oss << list;
+    buffer += oss.str();
+  }
+}
+
+#ifdef __cpp_lib_format
+// Formats a List as List[a, b, c]; the format spec applies to every element,
+// e.g. std::format("{:.2f}", list). Without one, numbers are printed the
+// way operator<< prints them.
+template<typename Ty, ListConfig Config>
+struct std::formatter<List<Ty, Config>> {
+  constexpr auto parse(std::format_parse_context& context)
+  {
+    m_hasSpec = context.begin() != context.end() && *context.begin() != '}';
+    return m_elementFormatter.parse(context);
+  }
+
+  template<typename FormatContext>
+  auto format(const List<Ty, Config>& list, FormatContext& context) const
+  {
+    if constexpr (hasToCharsFastPath<Ty>) {
+      if (!m_hasSpec) {
+        thread_local std::string buffer{};
+        buffer.clear();
+        appendTo(buffer, list);
+        return std::copy(buffer.begin(), buffer.end(), context.out());
+      }
+    }
+
+    auto out{std::copy_n("List[", 5, context.out())};
+    bool isFirst{true};
+
+    for (const Ty& element : list) {
+      if (!isFirst) { out = std::copy_n(", ", 2, out); }
+
+      context.advance_to(out);
+      out     = m_elementFormatter.format(element, context);
+      isFirst = false;
+    }
+
+    *out++ = ']';
+    return out;
+  }
+
+private:
+  std::formatter<Ty> m_elementFormatter{};
+  bool               m_hasSpec{false};
+};
+#endif
+#endif // INCG_LIST_FORMAT_HPP
@@ -0,0 +1,223 @@
+#ifndef INCG_LRU_CACHE_HPP
+#define INCG_LRU_CACHE_HPP
+#include <cstddef>
+
+#include <functional>
+#include <iterator>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+#include "list.hpp"
+
+// Charges every entry a cost of 1, i.e. limits a cache by its number of
+// entries.
+struct UnitCost {
+  template<typename Key, typename Value>
+  std::size_t operator()(const Key&, const Value&) const
+  {
+    return 1;
+  }
+};
+
+// A cache that evicts its least recently used entries once the total cost
+// of its entries exceeds its capacity.
+// The entries are kept in a List ordered from the most to the least recently
+// used one; a hit moves the entry's node to the front without allocating.
+// Cost is called as cost(key, value) and has to return the cost of an entry,
+// e.g. its size in bytes.
+// Key and Value have to be default constructible.
+template<
+  typename Key,
+  typename Value,
+  typename Cost  = UnitCost,
+  typename Hash  = std::hash<Key>,
+  typename Equal = std::equal_to<Key>>
+class LruCache {
+public:
+  using key_type    = Key;
+  using mapped_type = Value;
+  using this_type   = LruCache;
+  using size_type   = std::size_t;
+
+  struct Entry {
+    key_type    key;
+    mapped_type value;
+    size_type   cost;
+  };
+
+private:
+  using Entries = List<Entry>;
+
+public:
+  using const_iterator = typename Entries::const_iterator;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& cache)
+  {
+    if (cache.empty()) { return os << "LruCache[]"; }
+
+    os << "LruCache[";
+
+    const_iterator it{cache.begin()};
+    const_iterator lastElemIt{std::prev(cache.end())};
+
+    while (it != lastElemIt) {
+      os << it->key << ": " << it->value << ", ";
+      ++it;
+    }
+
+    os << lastElemIt->key << ": " << lastElemIt->value;
+    os << ']';
+    return os;
+  }
+
+  explicit LruCache(size_type capacity, Cost cost = Cost{})
+    : m_entries{}
+    , m_index{}
+    , m_cost{std::move(cost)}
+    , m_capacity{capacity}
+    , m_totalCost{0}
+    , m_hits{0}
+    , m_misses{0}
+    , m_evictions{0}
+  {
+  }
+
+  LruCache(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  size_type size() const { return m_entries.size(); }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  size_type capacity() const { return m_capacity; }
+
+  size_type total_cost() const { return m_totalCost; }
+
+  size_type hits() const { return m_hits; }
+
+  size_type misses() const { return m_misses; }
+
+  size_type evictions() const { return m_evictions; }
+
+  // Iterates from the most to the least recently used entry.
+  const_iterator begin() const { return m_entries.cbegin(); }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const { return m_entries.cend(); }
+
+  const_iterator cend() const { return end(); }
+
+  // Doesn't count as a use of the entry.
+  bool contains(const key_type& key) const
+  {
+    return m_index.find(key) != m_index.end();
+  }
+
+  // Returns the value cached for key and marks it as the most recently used
+  // entry, or returns nullptr if key isn't cached.
+  // The pointer stays valid until the entry is erased or evicted.
+  mapped_type* find(const key_type& key)
+  {
+    const auto indexIt{m_index.find(key)};
+
+    if (indexIt == m_index.end()) {
+      ++m_misses;
+      return nullptr;
+    }
+
+    ++m_hits;
+    touch(indexIt->second);
+    return &indexIt->second->value;
+  }
+
+  // Caches value under key as the most recently used entry, replacing the
+  // value cached for key before, and evicts the least recently used entries
+  // until the total cost fits into the capacity again.
+  // An entry that costs more than the capacity isn't cached at all, it only
+  // removes the value cached for key before; returns false in that case.
+  bool put(const key_type& key, const mapped_type& value)
+  {
+    const size_type cost{std::invoke(m_cost, key, value)};
+
+    if (cost > m_capacity) {
+      erase(key);
+      return false;
+    }
+
+    const auto indexIt{m_index.find(key)};
+
+    if (indexIt == m_index.end()) {
+      m_entries.push_front(Entry{key, value, cost});
+      m_index.emplace(key, m_entries.begin());
+    }
+    else {
+      typename Entries::iterator it{indexIt->second};
+      m_totalCost -= it->cost;
+      it->value = value;
+      it->cost  = cost;
+      touch(it);
+    }
+
+    m_totalCost += cost;
+
+    while (m_totalCost > m_capacity) { evict(); }
+
+    return true;
+  }
+
+  // Returns whether key was cached.
+  bool erase(const key_type& key)
+  {
+    const auto indexIt{m_index.find(key)};
+
+    if (indexIt == m_index.end()) { return false; }
+
+    m_totalCost -= indexIt->second->cost;
+    m_entries.erase(indexIt->second);
+    m_index.erase(indexIt);
+    return true;
+  }
+
+  void clear()
+  {
+    m_index.clear();
+    m_entries.clear();
+    m_totalCost = 0;
+  }
+
+  void reset_statistics()
+  {
+    m_hits      = 0;
+    m_misses    = 0;
+    m_evictions = 0;
+  }
+
+private:
+  void touch(typename Entries::iterator it)
+  {
+    m_entries.splice(m_entries.begin(), m_entries, it);
+  }
+
+  void evict()
+  {
+    const Entry& entry{m_entries.back()};
+    m_totalCost -= entry.cost;
+    m_index.erase(entry.key);
+    m_entries.pop_back();
+    ++m_evictions;
+  }
+
+  Entries m_entries;
+  std::unordered_map<key_type, typename Entries::iterator, Hash, Equal>
+            m_index;
+  Cost      m_cost;
+  size_type m_capacity;
+  size_type m_totalCost;
+  size_type m_hits;
+  size_type m_misses;
+  size_type m_evictions;
+};
+#endif // INCG_LRU_CACHE_HPP
@@ -0,0 +1,715 @@
+#ifndef INCG_MAPPED_LIST_HPP
+#define INCG_MAPPED_LIST_HPP
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <functional>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A doubly-linked list that lives entirely inside of a memory mapped file.
+// Nodes refer to each other through self-relative byte offsets, so the mapping
+// may be placed at any address: reopening an existing file only maps it,
+// nothing is parsed and no nodes are allocated.
+// Growing the file remaps it, which invalidates all iterators.
+template<typename Ty>
+class MappedList {
+public:
+  static_assert(
+    std::is_trivially_copyable_v<Ty>,
+    "MappedList requires a trivially copyable value_type.");
+
+  using value_type = Ty;
+
+private:
+  struct Node {
+    std::ptrdiff_t prev;
+    std::ptrdiff_t next;
+    value_type     value;
+  };
+
+  struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t nodeSize;
+    std::uint32_t nodeAlignment;
+    std::uint32_t valueSize;
+    std::uint64_t capacity; // in nodes, including the sentinel
+    std::uint64_t used;     // nodes handed out by the bump allocator
+    std::uint64_t size;
+    std::uint64_t freeList; // byte offset of the first free node, 0 if none
+  };
+
+  static constexpr char magicBytes[8]{'L', 'I', 'S', 'T', 'M', 'A', 'P'};
+  static constexpr std::uint32_t formatVersion{1};
+  static constexpr std::size_t   nodesOffset{
+    (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node)};
+
+public:
+  using this_type       = MappedList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = value_type&;
+  using const_reference = const value_type&;
+
+  class iterator {
+  public:
+    friend class MappedList;
+
+    using difference_type   = typename MappedList::difference_type;
+    using value_type        = typename MappedList::value_type;
+    using pointer           = value_type*;
+    using reference         = value_type&;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const iterator& lhs, const iterator& rhs)
+    {
+      return lhs.m_node == rhs.m_node;
+    }
+
+    friend bool operator!=(const iterator& lhs, const iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const iterator& it)
+    {
+      return os << "MappedList::iterator{" << it.m_node << '}';
+    }
+
+    iterator() : m_node{nullptr} {}
+
+    value_type& operator*() const { return m_node->value; }
+
+    value_type* operator->() const { return &m_node->value; }
+
+    iterator& operator++()
+    {
+      m_node = nextOf(m_node);
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    iterator& operator--()
+    {
+      m_node = prevOf(m_node);
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    explicit iterator(Node* node) : m_node{node} {}
+
+    Node* m_node;
+  };
+
+  class const_iterator {
+  public:
+    friend class MappedList;
+
+    using difference_type   = typename MappedList::difference_type;
+    using value_type        = typename MappedList::value_type;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_node == rhs.m_node;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "MappedList::const_iterator{" << cit.m_node << '}';
+    }
+
+    const_iterator() : m_node{nullptr} {}
+
+    /* IMPLICIT */ const_iterator(iterator it) : m_node{it.m_node} {}
+
+    const value_type& operator*() const { return m_node->value; }
+
+    const value_type* operator->() const { return &m_node->value; }
+
+    const_iterator& operator++()
+    {
+      m_node = nextOf(m_node);
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      m_node = prevOf(m_node);
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    explicit const_iterator(const Node* node) : m_node{node} {}
+
+    const Node* m_node;
+  };
+
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "MappedList[]"; }
+
+    os << "MappedList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  // Opens the list stored at path, creating the file with room for
+  // initialCapacity elements if it doesn't exist or is empty.
+  explicit MappedList(const std::string& path, size_type initialCapacity = 64)
+    : m_fd{-1}, m_mapping{nullptr}, m_mappingSize{0}
+  {
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (m_fd == -1) { throwSystemError("MappedList: could not open file"); }
+
+    try {
+      struct stat fileStatus {};
+
+      if (::fstat(m_fd, &fileStatus) == -1) {
+        throwSystemError("MappedList: could not stat file");
+      }
+
+      if (fileStatus.st_size == 0) {
+        create(initialCapacity + 1);
+      }
+      else {
+        open(static_cast<std::size_t>(fileStatus.st_size));
+      }
+    }
+    catch (...) {
+      unmap();
+      ::close(m_fd);
+      throw;
+    }
+  }
+
+  MappedList(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  MappedList(this_type&& other) noexcept
+    : m_fd{std::exchange(other.m_fd, -1)}
+    , m_mapping{std::exchange(other.m_mapping, nullptr)}
+    , m_mappingSize{std::exchange(other.m_mappingSize, 0)}
+  {
+  }
+
+  this_type& operator=(this_type&& other) noexcept
+  {
+    this_type newList{std::move(other)};
+    swap(newList);
+    return *this;
+  }
+
+  ~MappedList()
+  {
+    unmap();
+
+    if (m_fd != -1) { ::close(m_fd); }
+  }
+
+  size_type size() const { return header()->size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  // The number of elements that fit into the file without growing it.
+  size_type capacity() const { return header()->capacity - 1; }
+
+  reference front()
+  {
+    if (empty()) {
+      throw std::out_of_range{"MappedList::front called on empty list."};
+    }
+
+    return *begin();
+  }
+
+  const_reference front() const
+  {
+    return const_cast<this_type*>(this)->front();
+  }
+
+  reference back()
+  {
+    if (empty()) {
+      throw std::out_of_range{"MappedList::back called on empty list."};
+    }
+
+    return *rbegin();
+  }
+
+  const_reference back() const { return const_cast<this_type*>(this)->back(); }
+
+  iterator begin() { return iterator{nextOf(sentinel())}; }
+
+  const_iterator begin() const { return const_iterator{nextOf(sentinel())}; }
+
+  const_iterator cbegin() const { return begin(); }
+
+  iterator end() { return iterator{sentinel()}; }
+
+  const_iterator end() const { return const_iterator{sentinel()}; }
+
+  const_iterator cend() const { return end(); }
+
+  reverse_iterator rbegin() { return reverse_iterator{end()}; }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  reverse_iterator rend() { return reverse_iterator{begin()}; }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  void sort() { sort(std::less<value_type>{}); }
+
+  // Stable merge sort that only relinks nodes; no elements are copied.
+  template<typename BinaryComparator>
+  void sort(BinaryComparator binaryComparator)
+  {
+    Node* first{nextOf(sentinel())};
+    sortRange(first, size(), binaryComparator);
+  }
+
+  void push_back(const_reference element) { insert(end(), element); }
+
+  void push_front(const_reference element) { insert(begin(), element); }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    erase(std::prev(end()));
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    erase(begin());
+  }
+
+  // May grow the file, which invalidates all iterators except the one
+  // returned.
+  iterator insert(const_iterator pos, const_reference value)
+  {
+    // value may refer to an element, which growing the file would unmap.
+    const value_type  element{value};
+    const std::size_t posOffset{offsetOf(pos.m_node)};
+    Node*             newNode{allocateNode()};
+    Node*             node{nodeAt(posOffset)};
+    Node*             prev{prevOf(node)};
+
+    std::memcpy(&newNode->value, &element, sizeof(value_type));
+    link(newNode, prev, node);
+    ++header()->size;
+    return iterator{newNode};
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    Node* node{const_cast<Node*>(pos.m_node)};
+    Node* next{nextOf(node)};
+    Node* prev{prevOf(node)};
+
+    setNext(prev, next);
+    setPrev(next, prev);
+    --header()->size;
+    deallocateNode(node);
+    return iterator{next};
+  }
+
+  template<typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate unaryPredicate)
+  {
+    size_type elementsRemoved{0};
+
+    iterator it{begin()};
+
+    while (it != end()) {
+      if (std::invoke(unaryPredicate, *it)) {
+        it = erase(it);
+        ++elementsRemoved;
+      }
+      else {
+        ++it;
+      }
+    }
+
+    return elementsRemoved;
+  }
+
+  size_type remove(const_reference value)
+  {
+    return remove_if(
+      [&value](const_reference element) { return element == value; });
+  }
+
+  // Drops all elements; the file keeps its current capacity.
+  void clear()
+  {
+    Header* hdr{header()};
+    hdr->used     = 1;
+    hdr->size     = 0;
+    hdr->freeList = 0;
+    setNext(sentinel(), sentinel());
+    setPrev(sentinel(), sentinel());
+  }
+
+  // Synchronously writes the mapping back to the file.
+  void flush()
+  {
+    if (::msync(m_mapping, m_mappingSize, MS_SYNC) == -1) {
+      throwSystemError("MappedList::flush: msync failed");
+    }
+  }
+
+  void swap(this_type& other) noexcept
+  {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_mapping, other.m_mapping);
+    std::swap(m_mappingSize, other.m_mappingSize);
+  }
+
+private:
+  [[noreturn]] static void throwSystemError(const char* message)
+  {
+    throw std::system_error{errno, std::generic_category(), message};
+  }
+
+  static std::size_t bytesFor(std::uint64_t capacity)
+  {
+    return nodesOffset + static_cast<std::size_t>(capacity) * sizeof(Node);
+  }
+
+  static Node* follow(Node* node, std::ptrdiff_t offset)
+  {
+    return reinterpret_cast<Node*>(reinterpret_cast<char*>(node) + offset);
+  }
+
+  static const Node* follow(const Node* node, std::ptrdiff_t offset)
+  {
+    return reinterpret_cast<const Node*>(
+      reinterpret_cast<const char*>(node) + offset);
+  }
+
+  static std::ptrdiff_t distance(const Node* from, const Node* to)
+  {
+    return reinterpret_cast<const char*>(to)
+           - reinterpret_cast<const char*>(from);
+  }
+
+  static Node* nextOf(Node* node) { return follow(node, node->next); }
+
+  static const Node* nextOf(const Node* node)
+  {
+    return follow(node, node->next);
+  }
+
+  static Node* prevOf(Node* node) { return follow(node, node->prev); }
+
+  static const Node* prevOf(const Node* node)
+  {
+    return follow(node, node->prev);
+  }
+
+  static void setNext(Node* node, Node* next)
+  {
+    node->next = distance(node, next);
+  }
+
+  static void setPrev(Node* node, Node* prev)
+  {
+    node->prev = distance(node, prev);
+  }
+
+  static void link(Node* node, Node* prev, Node* next)
+  {
+    setPrev(node, prev);
+    setNext(node, next);
+    setNext(prev, node);
+    setPrev(next, node);
+  }
+
+  // Moves [first, last) in front of pos.
+  static void relinkBefore(Node* pos, Node* first, Node* last)
+  {
+    Node* lastIncluded{prevOf(last)};
+    Node* beforeFirst{prevOf(first)};
+    setNext(beforeFirst, last);
+    setPrev(last, beforeFirst);
+
+    Node* beforePos{prevOf(pos)};
+    setNext(beforePos, first);
+    setPrev(first, beforePos);
+    setNext(lastIncluded, pos);
+    setPrev(pos, lastIncluded);
+  }
+
+  // Sorts the count nodes starting at first, stores the new first node in
+  // first and returns the node following the sorted range.
+  template<typename BinaryComparator>
+  static Node* sortRange(
+    Node*&            first,
+    size_type         count,
+    BinaryComparator& binaryComparator)
+  {
+    if (count == 0) { return first; }
+
+    if (count == 1) { return nextOf(first); }
+
+    Node*       mid{sortRange(first, count / 2, binaryComparator)};
+    Node* const last{sortRange(mid, count - count / 2, binaryComparator)};
+    Node*       it{first};
+
+    if (std::invoke(binaryComparator, mid->value, first->value)) {
+      first = mid;
+    }
+
+    while (it != mid && mid != last) {
+      if (std::invoke(binaryComparator, mid->value, it->value)) {
+        Node* runEnd{nextOf(mid)};
+
+        while (runEnd != last
+               && std::invoke(binaryComparator, runEnd->value, it->value)) {
+          runEnd = nextOf(runEnd);
+        }
+
+        relinkBefore(it, mid, runEnd);
+        mid = runEnd;
+      }
+      else {
+        it = nextOf(it);
+      }
+    }
+
+    return last;
+  }
+
+  Header* header() { return static_cast<Header*>(m_mapping); }
+
+  const Header* header() const { return static_cast<const Header*>(m_mapping); }
+
+  Node* nodeAt(std::size_t offset)
+  {
+    return reinterpret_cast<Node*>(static_cast<char*>(m_mapping) + offset);
+  }
+
+  std::size_t offsetOf(const Node* node) const
+  {
+    return static_cast<std::size_t>(
+      reinterpret_cast<const char*>(node)
+      - static_cast<const char*>(m_mapping));
+  }
+
+  Node* sentinel() { return nodeAt(nodesOffset); }
+
+  const Node* sentinel() const
+  {
+    return const_cast<this_type*>(this)->sentinel();
+  }
+
+  void* mapFile(std::size_t bytes)
+  {
+    void* mapping{
+      ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0)};
+
+    if (mapping == MAP_FAILED) { throwSystemError("MappedList: mmap failed"); }
+
+    return mapping;
+  }
+
+  void map(std::size_t bytes)
+  {
+    m_mapping     = mapFile(bytes);
+    m_mappingSize = bytes;
+  }
+
+  void unmap() noexcept
+  {
+    if (m_mapping != nullptr) { ::munmap(m_mapping, m_mappingSize); }
+
+    m_mapping     = nullptr;
+    m_mappingSize = 0;
+  }
+
+  void resizeFile(std::size_t bytes)
+  {
+    if (::ftruncate(m_fd, static_cast<off_t>(bytes)) == -1) {
+      throwSystemError("MappedList: could not resize file");
+    }
+  }
+
+  void create(size_type initialCapacity)
+  {
+    const std::size_t bytes{bytesFor(initialCapacity)};
+    resizeFile(bytes);
+    map(bytes);
+
+    Header* hdr{header()};
+    std::memcpy(hdr->magic, magicBytes, sizeof(magicBytes));
+    hdr->version       = formatVersion;
+    hdr->nodeSize      = sizeof(Node);
+    hdr->nodeAlignment = alignof(Node);
+    hdr->valueSize     = sizeof(value_type);
+    hdr->capacity      = initialCapacity;
+    hdr->used          = 1;
+    hdr->size          = 0;
+    hdr->freeList      = 0;
+    setNext(sentinel(), sentinel());
+    setPrev(sentinel(), sentinel());
+  }
+
+  void open(std::size_t fileSize)
+  {
+    if (fileSize < bytesFor(1)) {
+      throw std::runtime_error{"MappedList: file is too small."};
+    }
+
+    map(fileSize);
+
+    const Header* hdr{header()};
+
+    if (
+      std::memcmp(hdr->magic, magicBytes, sizeof(magicBytes)) != 0
+      || hdr->version != formatVersion) {
+      throw std::runtime_error{"MappedList: file is not a MappedList."};
+    }
+
+    if (
+      hdr->nodeSize != sizeof(Node) || hdr->nodeAlignment != alignof(Node)
+      || hdr->valueSize != sizeof(value_type)) {
+      throw std::runtime_error{
+        "MappedList: file was written for a different value_type."};
+    }
+
+    if (bytesFor(hdr->capacity) > fileSize || hdr->used > hdr->capacity) {
+      throw std::runtime_error{"MappedList: file is truncated."};
+    }
+  }
+
+  void grow()
+  {
+    const std::uint64_t newCapacity{header()->capacity * 2};
+    const std::size_t   bytes{bytesFor(newCapacity)};
+    resizeFile(bytes);
+
+    // The old mapping is only given up once the new one exists, so that
+    // the list stays usable if mmap fails.
+    void* const mapping{mapFile(bytes)};
+    unmap();
+    m_mapping          = mapping;
+    m_mappingSize      = bytes;
+    header()->capacity = newCapacity;
+  }
+
+  Node* allocateNode()
+  {
+    if (header()->freeList != 0) {
+      Header* hdr{header()};
+      Node*   node{nodeAt(hdr->freeList)};
+      Node*   nextFree{nextOf(node)};
+      hdr->freeList = nextFree == node ? 0 : offsetOf(nextFree);
+      return node;
+    }
+
+    if (header()->used == header()->capacity) { grow(); }
+
+    Header* hdr{header()};
+    Node*   node{nodeAt(nodesOffset + hdr->used * sizeof(Node))};
+    ++hdr->used;
+    return node;
+  }
+
+  // Free nodes form a singly linked chain through next; the last free node
+  // refers to itself.
+  void deallocateNode(Node* node)
+  {
+    Header* hdr{header()};
+    setNext(node, hdr->freeList == 0 ? node : nodeAt(hdr->freeList));
+    hdr->freeList = offsetOf(node);
+  }
+
+  int         m_fd;
+  void*       m_mapping;
+  std::size_t m_mappingSize;
+};
+
+template<typename Ty>
+void swap(MappedList<Ty>& lhs, MappedList<Ty>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+#endif // INCG_MAPPED_LIST_HPP
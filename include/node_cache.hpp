@@ -0,0 +1,346 @@
+#ifndef INCG_NODE_CACHE_HPP
+#define INCG_NODE_CACHE_HPP
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Keeps the blocks of freed nodes of Size bytes per thread, so that lists
+// whose nodes come from it (see ListConfig::cachesNodes) reuse them instead
+// of calling operator new and delete for every node.
+// Every block remembers the cache of the thread that allocated it. Blocks
+// freed on another thread, e.g. by a consumer erasing the nodes a producer
+// built, are collected there and handed back batchSize at a time through a
+// lock-free inbox, which the owning thread empties with a single atomic
+// exchange once its own blocks run out. The blocks in the inbox count
+// towards maxCachedBlocks as well: batches handed back to a full inbox and
+// blocks drained from it beyond the limit go to operator delete.
+// The cache of a thread is retired when the thread exits and reused by the
+// next thread that needs one; blocks freed after their thread's cache was
+// retired go to operator delete. Only batches that were handed back while
+// the cache was being retired stay in its inbox until it is reused.
+template<std::size_t Size, std::size_t Alignment>
+class NodeCache {
+public:
+  static_assert(
+    Size >= sizeof(void*), "NodeCache: free blocks have to hold a pointer.");
+
+  // The number of blocks handed back to another thread at a time.
+  static constexpr std::size_t batchSize{64};
+
+  // Blocks beyond this many, whether freed by the thread that allocated them
+  // or handed back by others, go to operator delete, so that clearing a
+  // huge list doesn't hoard its memory.
+  static constexpr std::size_t maxCachedBlocks{4096};
+
+  NodeCache(const NodeCache&) = delete;
+
+  NodeCache& operator=(const NodeCache&) = delete;
+
+  // Returns a block of Size bytes aligned to Alignment.
+  static void* allocate()
+  {
+    NodeCache* const cache{local()};
+
+    if (cache != nullptr) {
+      if (void* const block{cache->take()}; block != nullptr) { return block; }
+    }
+
+    return newBlock(cache);
+  }
+
+  // Frees a block returned by allocate on any thread.
+  static void deallocate(void* block)
+  {
+    NodeCache* const origin{originOf(block)};
+    NodeCache* const cache{local()};
+
+    if (
+      origin == nullptr || cache == nullptr
+      || origin->m_retired.load(std::memory_order_relaxed)) {
+      deleteBlock(block);
+    }
+    else if (origin == cache) {
+      cache->keep(block);
+    }
+    else {
+      cache->giveBack(origin, block);
+    }
+  }
+
+  // Hands the blocks that the calling thread collected for another thread
+  // back right away instead of waiting for a full batch, e.g. before it
+  // goes idle.
+  static void flush()
+  {
+    if (NodeCache* const cache{local()}; cache != nullptr) {
+      cache->flushPending();
+    }
+  }
+
+  // The number of free blocks the cache of the calling thread holds, not
+  // counting the ones still in its inbox.
+  static std::size_t cached_blocks()
+  {
+    const NodeCache* const cache{local()};
+    return cache == nullptr ? 0 : cache->m_freeCount;
+  }
+
+private:
+  struct ThreadState {
+    NodeCache* cache;
+    bool       exited;
+  };
+
+  // Retires the cache of its thread when the thread exits.
+  struct Retirer {
+    Retirer()                          = default;
+    Retirer(const Retirer&)            = delete;
+    Retirer& operator=(const Retirer&) = delete;
+
+    ~Retirer()
+    {
+      ThreadState& state{threadState()};
+      state.exited = true;
+
+      if (state.cache != nullptr) {
+        retire(std::exchange(state.cache, nullptr));
+      }
+    }
+  };
+
+  // The caches of exited threads; never destroyed, since blocks may still
+  // be handed back to them while the program exits.
+  struct Pool {
+    std::mutex              mutex;
+    std::vector<NodeCache*> retired;
+  };
+
+  static constexpr std::size_t blockAlignment{
+    std::max(Alignment, alignof(NodeCache*))};
+
+  // The origin is stored in front of the block.
+  static constexpr std::size_t headerSize{
+    (sizeof(NodeCache*) + blockAlignment - 1) / blockAlignment
+    * blockAlignment};
+
+  NodeCache()
+    : m_free{nullptr}
+    , m_freeCount{0}
+    , m_inbox{nullptr}
+    , m_inboxCount{0}
+    , m_retired{false}
+    , m_pendingOrigin{nullptr}
+    , m_pending{nullptr}
+    , m_pendingTail{nullptr}
+    , m_pendingCount{0}
+  {
+  }
+
+  ~NodeCache() = default;
+
+  // Trivially destructible, so it can still be used while the other thread
+  // locals of the thread, e.g. lists, are destroyed.
+  static ThreadState& threadState()
+  {
+    thread_local ThreadState state{nullptr, false};
+    return state;
+  }
+
+  // The cache of the calling thread, or nullptr once the thread is exiting.
+  static NodeCache* local()
+  {
+    ThreadState& state{threadState()};
+
+    if (state.cache == nullptr && !state.exited) {
+      thread_local const Retirer retirer{};
+      state.cache = adopt();
+    }
+
+    return state.cache;
+  }
+
+  static Pool& pool()
+  {
+    static Pool& instance{*new Pool{}};
+    return instance;
+  }
+
+  static NodeCache* adopt()
+  {
+    Pool&                             caches{pool()};
+    const std::lock_guard<std::mutex> lock{caches.mutex};
+
+    if (caches.retired.empty()) { return new NodeCache{}; }
+
+    NodeCache* const cache{caches.retired.back()};
+    caches.retired.pop_back();
+    cache->m_retired.store(false, std::memory_order_relaxed);
+    return cache;
+  }
+
+  static void retire(NodeCache* cache)
+  {
+    cache->m_retired.store(true, std::memory_order_relaxed);
+    cache->flushPending();
+    deleteBlocks(std::exchange(cache->m_free, nullptr));
+    cache->m_freeCount = 0;
+    cache->drainInbox(0);
+
+    Pool&                             caches{pool()};
+    const std::lock_guard<std::mutex> lock{caches.mutex};
+    caches.retired.push_back(cache);
+  }
+
+  static void*& nextOf(void* block) { return *static_cast<void**>(block); }
+
+  static NodeCache*& originOf(void* block)
+  {
+    return *reinterpret_cast<NodeCache**>(
+      static_cast<char*>(block) - headerSize);
+  }
+
+  static void* newBlock(NodeCache* origin)
+  {
+    char* const memory{static_cast<char*>(::operator new(
+      headerSize + Size, std::align_val_t{blockAlignment}))};
+    void* const block{memory + headerSize};
+    ::new (static_cast<void*>(memory)) NodeCache*{origin};
+    return block;
+  }
+
+  static void deleteBlock(void* block)
+  {
+    ::operator delete(
+      static_cast<char*>(block) - headerSize,
+      headerSize + Size,
+      std::align_val_t{blockAlignment});
+  }
+
+  static void deleteBlocks(void* block)
+  {
+    while (block != nullptr) {
+      void* const next{nextOf(block)};
+      deleteBlock(block);
+      block = next;
+    }
+  }
+
+  void* take()
+  {
+    if (m_free == nullptr) {
+      drainInbox(maxCachedBlocks);
+
+      if (m_free == nullptr) { return nullptr; }
+    }
+
+    --m_freeCount;
+    return std::exchange(m_free, nextOf(m_free));
+  }
+
+  // Moves the blocks of the inbox to the free blocks until there are limit
+  // of them and deletes the rest.
+  void drainInbox(std::size_t limit)
+  {
+    void*       block{m_inbox.exchange(nullptr, std::memory_order_acquire)};
+    std::size_t count{0};
+
+    for (; block != nullptr; ++count) {
+      void* const next{nextOf(block)};
+
+      if (m_freeCount < limit) {
+        nextOf(block) = m_free;
+        m_free        = block;
+        ++m_freeCount;
+      }
+      else {
+        deleteBlock(block);
+      }
+
+      block = next;
+    }
+
+    m_inboxCount.fetch_sub(count, std::memory_order_relaxed);
+  }
+
+  void keep(void* block)
+  {
+    if (m_freeCount == maxCachedBlocks) {
+      deleteBlock(block);
+      return;
+    }
+
+    nextOf(block) = m_free;
+    m_free        = block;
+    ++m_freeCount;
+  }
+
+  void giveBack(NodeCache* origin, void* block)
+  {
+    if (origin != m_pendingOrigin) {
+      flushPending();
+      m_pendingOrigin = origin;
+      m_pendingTail   = block;
+    }
+
+    nextOf(block) = m_pending;
+    m_pending     = block;
+
+    if (++m_pendingCount == batchSize) { flushPending(); }
+  }
+
+  void flushPending()
+  {
+    if (m_pending == nullptr) { return; }
+
+    NodeCache* const origin{m_pendingOrigin};
+
+    if (
+      origin->m_retired.load(std::memory_order_relaxed)
+      || origin->m_inboxCount.load(std::memory_order_relaxed)
+           >= maxCachedBlocks) {
+      deleteBlocks(m_pending);
+    }
+    else {
+      // Counted before the batch is pushed, so that draining it never
+      // subtracts more than was added.
+      origin->m_inboxCount.fetch_add(m_pendingCount, std::memory_order_relaxed);
+      std::atomic<void*>& inbox{origin->m_inbox};
+      void*               head{inbox.load(std::memory_order_relaxed)};
+
+      do {
+        nextOf(m_pendingTail) = head;
+      } while (!inbox.compare_exchange_weak(
+        head, m_pending, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    m_pendingOrigin = nullptr;
+    m_pending       = nullptr;
+    m_pendingTail   = nullptr;
+    m_pendingCount  = 0;
+  }
+
+  // Only used by the thread that owns the cache.
+  void*       m_free;
+  std::size_t m_freeCount;
+
+  // The batches that other threads handed back and the number of blocks in
+  // them.
+  std::atomic<void*>       m_inbox;
+  std::atomic<std::size_t> m_inboxCount;
+
+  // Set while no thread owns the cache, so that its blocks are deleted
+  // instead of handed back.
+  std::atomic<bool> m_retired;
+
+  // The blocks of another thread's cache collected for the next batch.
+  NodeCache*  m_pendingOrigin;
+  void*       m_pending;
+  void*       m_pendingTail;
+  std::size_t m_pendingCount;
+};
+#endif // INCG_NODE_CACHE_HPP
@@ -0,0 +1,428 @@
+#ifndef INCG_PERSISTENT_LIST_HPP
+#define INCG_PERSISTENT_LIST_HPP
+#include <cstddef>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "list.hpp"
+
+// A list whose copies share their elements.
+// The elements are stored in segments, each of which is a reference counted
+// List of up to 2 * segmentCapacity elements.
+// Copying a PersistentList only copies a reference to its table of segments.
+// The first mutation of a shared version copies that table, which holds one
+// pointer per segment, and the single segment being modified; all other
+// segments stay shared between the versions.
+// Elements can't be modified through iterators.
+// All iterators are invalidated by mutations.
+template<typename Ty>
+class PersistentList {
+public:
+  using value_type      = Ty;
+  using this_type       = PersistentList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = const value_type&;
+  using const_reference = const value_type&;
+
+  static constexpr size_type segmentCapacity{64};
+
+private:
+  using Segment = List<value_type>;
+  using Spine   = std::vector<std::shared_ptr<Segment>>;
+
+public:
+  class const_iterator {
+  public:
+    friend class PersistentList;
+
+    using difference_type   = typename PersistentList::difference_type;
+    using value_type        = typename PersistentList::value_type;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_segmentIndex == rhs.m_segmentIndex && lhs.m_it == rhs.m_it;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "PersistentList::const_iterator{" << cit.m_segmentIndex
+                << ", " << cit.m_it << '}';
+    }
+
+    const value_type& operator*() const { return *m_it; }
+
+    const value_type* operator->() const { return &*m_it; }
+
+    const_iterator& operator++()
+    {
+      ++m_it;
+
+      if (
+        m_it == segment().end() && m_segmentIndex + 1 < m_spine->size()) {
+        ++m_segmentIndex;
+        m_it = segment().begin();
+      }
+
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      if (m_it == segment().begin()) {
+        --m_segmentIndex;
+        m_it = segment().end();
+      }
+
+      --m_it;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    const_iterator(
+      const Spine*                     spine,
+      size_type                        segmentIndex,
+      typename Segment::const_iterator it)
+      : m_spine{spine}, m_segmentIndex{segmentIndex}, m_it{it}
+    {
+    }
+
+    const Segment& segment() const { return *(*m_spine)[m_segmentIndex]; }
+
+    const Spine*                     m_spine;
+    size_type                        m_segmentIndex;
+    typename Segment::const_iterator m_it;
+  };
+
+  using iterator               = const_iterator;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "PersistentList[]"; }
+
+    os << "PersistentList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  {
+    if (lhs.m_spine == rhs.m_spine) { return true; }
+
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  PersistentList()
+    : m_spine{std::make_shared<Spine>(1, std::make_shared<Segment>())}
+    , m_size{0}
+  {
+  }
+
+  explicit PersistentList(const List<value_type>& list) : PersistentList{}
+  {
+    for (const value_type& element : list) { push_back(element); }
+  }
+
+  PersistentList(std::initializer_list<value_type> initList) : PersistentList{}
+  {
+    for (const value_type& elementToAdd : initList) { push_back(elementToAdd); }
+  }
+
+  // O(1), the new list shares all of its segments with other.
+  PersistentList(const this_type& other) = default;
+
+  this_type& operator=(const this_type& other) = default;
+
+  size_type size() const { return m_size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  const_reference front() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"PersistentList::front called on empty list."};
+    }
+
+    return *begin();
+  }
+
+  const_reference back() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"PersistentList::back called on empty list."};
+    }
+
+    return *std::prev(end());
+  }
+
+  const_reference operator[](size_type index) const
+  {
+    if (index >= size()) {
+      std::string errorMessage{
+        "PersistentList::operator[]: index out of bounds: "};
+      errorMessage += std::to_string(index);
+      errorMessage += " is >= size() (";
+      errorMessage += std::to_string(size());
+      errorMessage += ")!";
+
+      throw std::out_of_range{errorMessage};
+    }
+
+    return *makeIterator(0, index);
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator{m_spine.get(), 0, m_spine->front()->cbegin()};
+  }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const
+  {
+    return const_iterator{
+      m_spine.get(), m_spine->size() - 1, m_spine->back()->cend()};
+  }
+
+  const_iterator cend() const { return end(); }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  void push_back(const_reference element)
+  {
+    Spine& spine{mutableSpine()};
+
+    if (spine.back()->size() >= segmentCapacity) {
+      spine.push_back(newSegment(element));
+    }
+    else {
+      mutableSegment(spine.size() - 1).push_back(element);
+    }
+
+    ++m_size;
+  }
+
+  void push_front(const_reference element)
+  {
+    Spine& spine{mutableSpine()};
+
+    if (spine.front()->size() >= segmentCapacity) {
+      spine.insert(spine.begin(), newSegment(element));
+    }
+    else {
+      mutableSegment(0).push_front(element);
+    }
+
+    ++m_size;
+  }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    erase(std::prev(end()));
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    erase(begin());
+  }
+
+  const_iterator insert(const_iterator pos, const_reference value)
+  {
+    auto [segmentIndex, offset]{locate(pos)};
+    Segment& segment{mutableSegment(segmentIndex)};
+    segment.insert(std::next(segment.begin(), offset), value);
+    ++m_size;
+
+    if (segment.size() > 2 * segmentCapacity) {
+      const size_type keep{segment.size() / 2};
+      split(segmentIndex, keep);
+
+      if (offset >= keep) {
+        ++segmentIndex;
+        offset -= keep;
+      }
+    }
+
+    return makeIterator(segmentIndex, offset);
+  }
+
+  const_iterator erase(const_iterator pos)
+  {
+    const auto [segmentIndex, offset]{locate(pos)};
+    Segment& segment{mutableSegment(segmentIndex)};
+    segment.erase(std::next(segment.begin(), offset));
+    --m_size;
+
+    if (segment.empty() && m_spine->size() > 1) {
+      m_spine->erase(m_spine->begin() + segmentIndex);
+      return makeIterator(segmentIndex, 0);
+    }
+
+    return makeIterator(segmentIndex, offset);
+  }
+
+  void clear() { *this = this_type{}; }
+
+  List<value_type> toList() const
+  {
+    List<value_type> list{};
+
+    for (const value_type& element : *this) { list.push_back(element); }
+
+    return list;
+  }
+
+  void swap(this_type& other) noexcept
+  {
+    m_spine.swap(other.m_spine);
+    std::swap(m_size, other.m_size);
+  }
+
+private:
+  Spine& mutableSpine()
+  {
+    if (m_spine.use_count() > 1) {
+      m_spine = std::make_shared<Spine>(*m_spine);
+    }
+
+    return *m_spine;
+  }
+
+  Segment& mutableSegment(size_type segmentIndex)
+  {
+    std::shared_ptr<Segment>& segment{mutableSpine()[segmentIndex]};
+
+    if (segment.use_count() > 1) {
+      segment = std::make_shared<Segment>(*segment);
+    }
+
+    return *segment;
+  }
+
+  // Makes a segment holding element before it is added to the spine, so
+  // that a throwing copy doesn't leave an empty segment behind.
+  static std::shared_ptr<Segment> newSegment(const_reference element)
+  {
+    std::shared_ptr<Segment> segment{std::make_shared<Segment>()};
+    segment->push_back(element);
+    return segment;
+  }
+
+  std::pair<size_type, size_type> locate(const_iterator pos) const
+  {
+    const Segment& segment{*(*m_spine)[pos.m_segmentIndex]};
+    return {
+      pos.m_segmentIndex,
+      static_cast<size_type>(std::distance(segment.cbegin(), pos.m_it))};
+  }
+
+  // Returns the iterator to the element offset positions after the beginning
+  // of the segment at segmentIndex, which may be located in a later segment.
+  const_iterator makeIterator(size_type segmentIndex, size_type offset) const
+  {
+    const Spine& spine{*m_spine};
+
+    if (segmentIndex == spine.size()) { return end(); }
+
+    while (segmentIndex + 1 < spine.size()
+           && offset >= spine[segmentIndex]->size()) {
+      offset -= spine[segmentIndex]->size();
+      ++segmentIndex;
+    }
+
+    return const_iterator{
+      &spine,
+      segmentIndex,
+      std::next(spine[segmentIndex]->cbegin(), offset)};
+  }
+
+  // Moves all but the first keep elements of a uniquely owned segment into a
+  // new segment following it.
+  void split(size_type segmentIndex, size_type keep)
+  {
+    Segment&                 segment{*(*m_spine)[segmentIndex]};
+    std::shared_ptr<Segment> tail{std::make_shared<Segment>()};
+
+    for (auto it{std::next(segment.cbegin(), keep)}; it != segment.cend();
+         ++it) {
+      tail->push_back(*it);
+    }
+
+    segment.resize(keep);
+    m_spine->insert(m_spine->begin() + segmentIndex + 1, std::move(tail));
+  }
+
+  std::shared_ptr<Spine> m_spine;
+  size_type              m_size;
+};
+
+template<typename Ty>
+void swap(PersistentList<Ty>& lhs, PersistentList<Ty>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+#endif // INCG_PERSISTENT_LIST_HPP
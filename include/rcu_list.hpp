@@ -0,0 +1,435 @@
+#ifndef INCG_RCU_LIST_HPP
+#define INCG_RCU_LIST_HPP
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "allocation_tracking.hpp"
+
+// A list for one writer thread and many concurrent reader threads.
+// Readers traverse it without taking locks inside of a read-side critical
+// section:
+//
+//   RcuList<int>::Reader reader{list}; // once per reader thread
+//   {
+//     auto guard{reader.lock()};
+//     for (int element : guard) { ... }
+//   }
+//
+// All other member functions may only be called by the writer thread.
+// The writer publishes new links with sequentially consistent stores, so
+// readers always see fully constructed nodes, and retires erased nodes
+// instead of deleting them. Retired nodes are freed through epoch based
+// reclamation once every reader that could still hold a reference to them
+// has left its critical section.
+// Readers can only traverse the list forwards; elements are immutable once
+// published.
+template<typename Ty, std::size_t MaxReaders = 64>
+class RcuList {
+public:
+  using value_type      = Ty;
+  using this_type       = RcuList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = const value_type&;
+  using const_reference = const value_type&;
+
+private:
+  struct Node {
+    value_type         value;
+    Node*              prev; // only used by the writer
+    std::atomic<Node*> next;
+  };
+
+  // Epoch 0 means that the reader owning the slot is not inside of a
+  // critical section.
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool>          inUse{false};
+  };
+
+  struct RetiredNode {
+    Node*         node;
+    std::uint64_t epoch;
+  };
+
+  static constexpr size_type reclaimThreshold{64};
+
+public:
+  class ReadGuard;
+
+  class const_iterator {
+  public:
+    friend class RcuList;
+    friend class ReadGuard;
+
+    using difference_type   = typename RcuList::difference_type;
+    using value_type        = typename RcuList::value_type;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+    using iterator_category = std::forward_iterator_tag;
+    using iterator_concept  = std::forward_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_node == rhs.m_node;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "RcuList::const_iterator{" << cit.m_node << '}';
+    }
+
+    const_iterator() : m_node{nullptr} {}
+
+    const value_type& operator*() const { return m_node->value; }
+
+    const value_type* operator->() const { return &m_node->value; }
+
+    const_iterator& operator++()
+    {
+      m_node = m_node->next.load();
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+  private:
+    explicit const_iterator(const Node* node) : m_node{node} {}
+
+    const Node* m_node;
+  };
+
+  using iterator = const_iterator;
+
+  // Registers a reader thread with a list; holds one of its MaxReaders epoch
+  // slots until destroyed.
+  class Reader {
+  public:
+    friend class ReadGuard;
+
+    explicit Reader(const this_type& list) : m_list{&list}, m_slot{nullptr}
+    {
+      for (Slot& slot : list.m_slots) {
+        bool expected{false};
+
+        if (slot.inUse.compare_exchange_strong(expected, true)) {
+          m_slot = &slot;
+          return;
+        }
+      }
+
+      throw std::runtime_error{"RcuList::Reader: too many readers."};
+    }
+
+    Reader(const Reader&) = delete;
+
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader() { m_slot->inUse.store(false); }
+
+    // Enters a read-side critical section that lasts as long as the returned
+    // guard. Must not be nested.
+    ReadGuard lock() { return ReadGuard{*this}; }
+
+  private:
+    const this_type* m_list;
+    Slot*            m_slot;
+  };
+
+  class ReadGuard {
+  public:
+    friend class Reader;
+
+    ReadGuard(const ReadGuard&) = delete;
+
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    ~ReadGuard()
+    {
+      m_reader->m_slot->epoch.store(0, std::memory_order_release);
+    }
+
+    const_iterator begin() const
+    {
+      return const_iterator{m_reader->m_list->m_head.load()};
+    }
+
+    const_iterator end() const { return const_iterator{}; }
+
+  private:
+    // The sequentially consistent store orders the announcement of the epoch
+    // before all loads of the traversal, so the writer either sees this
+    // reader in its epoch or the reader sees every unlink that preceded the
+    // writer's check.
+    explicit ReadGuard(Reader& reader) : m_reader{&reader}
+    {
+      m_reader->m_slot->epoch.store(m_reader->m_list->m_epoch.load());
+    }
+
+    Reader* m_reader;
+  };
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "RcuList[]"; }
+
+    os << "RcuList[";
+
+    const_iterator it{list.begin()};
+
+    while (std::next(it) != list.end()) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *it;
+    os << ']';
+    return os;
+  }
+
+  RcuList() : m_head{nullptr}, m_tail{nullptr}, m_size{0}, m_epoch{1} {}
+
+  RcuList(const this_type&) = delete;
+
+  this_type& operator=(const this_type&) = delete;
+
+  // There must not be any registered readers left.
+  ~RcuList()
+  {
+    destroyChain(m_head.load(std::memory_order_relaxed));
+
+    for (const RetiredNode& retiredNode : m_retired) {
+      destroyNode(retiredNode.node);
+    }
+  }
+
+  size_type size() const { return m_size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  // The number of erased nodes that haven't been freed yet.
+  size_type retired_size() const { return m_retired.size(); }
+
+  reference front() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"RcuList::front called on empty list."};
+    }
+
+    return *begin();
+  }
+
+  reference back() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"RcuList::back called on empty list."};
+    }
+
+    return m_tail->value;
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator{m_head.load(std::memory_order_relaxed)};
+  }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const { return const_iterator{}; }
+
+  const_iterator cend() const { return end(); }
+
+  void push_back(const_reference element) { insert(end(), element); }
+
+  void push_front(const_reference element) { insert(begin(), element); }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    erase(const_iterator{m_tail});
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    erase(begin());
+  }
+
+  iterator insert(const_iterator pos, const_reference value)
+  {
+    Node* next{const_cast<Node*>(pos.m_node)};
+    Node* prev{next == nullptr ? m_tail : next->prev};
+    Node* newNode{createNode(value, prev, next)};
+
+    // Publishes the fully constructed node.
+    if (prev == nullptr) { m_head.store(newNode); }
+    else {
+      prev->next.store(newNode);
+    }
+
+    if (next == nullptr) { m_tail = newNode; }
+    else {
+      next->prev = newNode;
+    }
+
+    ++m_size;
+    return iterator{newNode};
+  }
+
+  // Unlinks the node at pos; readers that are currently positioned on it
+  // can still continue their traversal from there.
+  iterator erase(const_iterator pos)
+  {
+    Node* node{const_cast<Node*>(pos.m_node)};
+    Node* next{node->next.load(std::memory_order_relaxed)};
+    Node* prev{node->prev};
+
+    if (prev == nullptr) { m_head.store(next); }
+    else {
+      prev->next.store(next);
+    }
+
+    if (next == nullptr) { m_tail = prev; }
+    else {
+      next->prev = prev;
+    }
+
+    --m_size;
+    retire(node);
+    return iterator{next};
+  }
+
+  template<typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate unaryPredicate)
+  {
+    size_type elementsRemoved{0};
+
+    iterator it{begin()};
+
+    while (it != end()) {
+      if (std::invoke(unaryPredicate, *it)) {
+        it = erase(it);
+        ++elementsRemoved;
+      }
+      else {
+        ++it;
+      }
+    }
+
+    return elementsRemoved;
+  }
+
+  size_type remove(const_reference value)
+  {
+    return remove_if(
+      [&value](const_reference element) { return element == value; });
+  }
+
+  void clear()
+  {
+    while (!empty()) { pop_front(); }
+  }
+
+  // Frees the retired nodes that no reader can reach anymore.
+  void reclaim()
+  {
+    std::uint64_t oldestActiveEpoch{std::numeric_limits<std::uint64_t>::max()};
+
+    for (const Slot& slot : m_slots) {
+      const std::uint64_t epoch{slot.epoch.load()};
+
+      if (epoch != 0) {
+        oldestActiveEpoch = std::min(oldestActiveEpoch, epoch);
+      }
+    }
+
+    const auto firstRemaining{std::partition(
+      m_retired.begin(),
+      m_retired.end(),
+      [oldestActiveEpoch](const RetiredNode& retiredNode) {
+        return retiredNode.epoch < oldestActiveEpoch;
+      })};
+
+    for (auto it{m_retired.begin()}; it != firstRemaining; ++it) {
+      destroyNode(it->node);
+    }
+
+    m_retired.erase(m_retired.begin(), firstRemaining);
+  }
+
+  // Waits for the current grace period to end, i.e. until all nodes that
+  // have been erased so far are freed.
+  void synchronize()
+  {
+    reclaim();
+
+    while (!m_retired.empty()) {
+      std::this_thread::yield();
+      reclaim();
+    }
+  }
+
+private:
+  static Node* createNode(const_reference value, Node* prev, Node* next)
+  {
+    Node* newNode{new Node{value, prev, {next}}};
+    trackAllocation(newNode);
+    return newNode;
+  }
+
+  static void destroyNode(Node* node)
+  {
+    trackDeallocation(node);
+    delete node;
+  }
+
+  static void destroyChain(Node* node)
+  {
+    while (node != nullptr) {
+      Node* next{node->next.load(std::memory_order_relaxed)};
+      destroyNode(node);
+      node = next;
+    }
+  }
+
+  // Readers that entered their critical section before the epoch was
+  // advanced may still reach the node; those that entered afterwards can't.
+  void retire(Node* node)
+  {
+    m_retired.push_back(RetiredNode{node, m_epoch.fetch_add(1)});
+
+    if (m_retired.size() >= reclaimThreshold) { reclaim(); }
+  }
+
+  std::atomic<Node*>         m_head;
+  Node*                      m_tail;
+  size_type                  m_size;
+  std::atomic<std::uint64_t> m_epoch;
+  mutable std::array<Slot, MaxReaders> m_slots;
+  std::vector<RetiredNode>             m_retired;
+};
+#endif // INCG_RCU_LIST_HPP
@@ -0,0 +1,99 @@
+#ifndef INCG_RECLAIMER_HPP
+#define INCG_RECLAIMER_HPP
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Runs cleanup jobs, e.g. freeing the nodes of a huge list, on a background
+// thread, so that the threads that hand them over don't have to wait for
+// them.
+class Reclaimer {
+public:
+  Reclaimer()
+    : m_mutex{}
+    , m_jobAvailable{}
+    , m_idle{}
+    , m_jobs{}
+    , m_running{false}
+    , m_stopping{false}
+    , m_thread{[this] { work(); }}
+  {
+  }
+
+  Reclaimer(const Reclaimer&) = delete;
+
+  Reclaimer& operator=(const Reclaimer&) = delete;
+
+  // Runs the jobs that are still pending before returning.
+  ~Reclaimer()
+  {
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      m_stopping = true;
+    }
+
+    m_jobAvailable.notify_one();
+    m_thread.join();
+  }
+
+  // The reclaimer that is used if none is given; its thread runs until the
+  // program exits.
+  static Reclaimer& instance()
+  {
+    static Reclaimer reclaimer{};
+    return reclaimer;
+  }
+
+  // Jobs run one after the other in the order they were posted.
+  void post(std::function<void()> job)
+  {
+    {
+      const std::lock_guard<std::mutex> lock{m_mutex};
+      m_jobs.push_back(std::move(job));
+    }
+
+    m_jobAvailable.notify_one();
+  }
+
+  // Blocks until all jobs posted before have run.
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_idle.wait(lock, [this] { return m_jobs.empty() && !m_running; });
+  }
+
+private:
+  void work()
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (true) {
+      m_jobAvailable.wait(
+        lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+      if (m_jobs.empty()) { return; }
+
+      std::function<void()> job{std::move(m_jobs.front())};
+      m_jobs.pop_front();
+      m_running = true;
+      lock.unlock();
+      job();
+      lock.lock();
+      m_running = false;
+
+      if (m_jobs.empty()) { m_idle.notify_all(); }
+    }
+  }
+
+  std::mutex                        m_mutex;
+  std::condition_variable           m_jobAvailable;
+  std::condition_variable           m_idle;
+  std::deque<std::function<void()>> m_jobs;
+  bool                              m_running;
+  bool                              m_stopping;
+  std::thread                       m_thread;
+};
+#endif // INCG_RECLAIMER_HPP
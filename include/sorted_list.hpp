@@ -0,0 +1,594 @@
+#ifndef INCG_SORTED_LIST_HPP
+#define INCG_SORTED_LIST_HPP
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "allocation_tracking.hpp"
+
+// A list that keeps its elements sorted according to Compare.
+// The nodes form a skip list: besides the doubly linked chain of all nodes,
+// every node has a random number of additional forward links, each of which
+// skips over roughly four times as many nodes as the one below it.
+// Searching descends through those links, so insert, find, lower_bound,
+// upper_bound and equal_range take O(log n) expected time.
+// Equal elements are kept in insertion order.
+// Elements can't be modified through iterators, as that could break the
+// order.
+template<typename Ty, typename Compare = std::less<Ty>>
+class SortedList {
+public:
+  using value_type      = Ty;
+  using this_type       = SortedList;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = const value_type&;
+  using const_reference = const value_type&;
+  using value_compare   = Compare;
+
+  static constexpr size_type maxHeight{32};
+
+private:
+  // The head of the list only has the links, real nodes also have a value.
+  // The links of a node are stored in the same allocation, right after it.
+  struct NodeBase {
+    NodeBase*  prev;
+    NodeBase** next;
+    size_type  height;
+  };
+
+  struct Node : NodeBase {
+    value_type value;
+  };
+
+  // Predecessors of a position on every level.
+  using Path = std::array<NodeBase*, maxHeight>;
+
+public:
+  class const_iterator {
+  public:
+    friend class SortedList;
+
+    using difference_type   = typename SortedList::difference_type;
+    using value_type        = typename SortedList::value_type;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using iterator_concept  = std::bidirectional_iterator_tag; // C++20
+
+    friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return lhs.m_node == rhs.m_node;
+    }
+
+    friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs)
+    {
+      return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const const_iterator& cit)
+    {
+      return os << "SortedList::const_iterator{" << cit.m_node << '}';
+    }
+
+    const value_type& operator*() const
+    {
+      return static_cast<const Node*>(m_node)->value;
+    }
+
+    const value_type* operator->() const { return &**this; }
+
+    const_iterator& operator++()
+    {
+      m_node = m_node->next[0];
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator it{*this};
+      ++(*this);
+      return it;
+    }
+
+    const_iterator& operator--()
+    {
+      m_node = m_node->prev;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator it{*this};
+      --(*this);
+      return it;
+    }
+
+  private:
+    explicit const_iterator(NodeBase* node) : m_node{node} {}
+
+    NodeBase* m_node;
+  };
+
+  using iterator               = const_iterator;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  friend std::ostream& operator<<(std::ostream& os, const this_type& list)
+  {
+    if (list.empty()) { return os << "SortedList[]"; }
+
+    os << "SortedList[";
+
+    const_iterator it{list.begin()};
+    const_iterator lastElemIt{std::prev(list.end())};
+
+    while (it != lastElemIt) {
+      os << *it << ", ";
+      ++it;
+    }
+
+    os << *lastElemIt;
+    os << ']';
+    return os;
+  }
+
+  friend bool operator==(const this_type& lhs, const this_type& rhs)
+  {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend bool operator!=(const this_type& lhs, const this_type& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+  explicit SortedList(Compare compare = Compare{})
+    : m_head{nullptr}
+    , m_size{0}
+    , m_height{1}
+    , m_compare{std::move(compare)}
+    , m_randomState{0x9e3779b97f4a7c15}
+  {
+    m_head = createNodeBase(maxHeight);
+    std::fill_n(m_head->next, maxHeight, m_head);
+    m_head->prev = m_head;
+  }
+
+  SortedList(std::initializer_list<value_type> initList, Compare compare = {})
+    : SortedList{std::move(compare)}
+  {
+    for (const value_type& elementToAdd : initList) { insert(elementToAdd); }
+  }
+
+  SortedList(const this_type& other) : SortedList{other.m_compare}
+  {
+    insert_sorted(other.begin(), other.end());
+  }
+
+  this_type& operator=(const this_type& other)
+  {
+    this_type newList{other};
+    swap(newList);
+    return *this;
+  }
+
+  ~SortedList()
+  {
+    clear();
+    destroyNodeBase(m_head);
+  }
+
+  size_type size() const { return m_size; }
+
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  const_reference front() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"SortedList::front called on empty list."};
+    }
+
+    return *begin();
+  }
+
+  const_reference back() const
+  {
+    if (empty()) {
+      throw std::out_of_range{"SortedList::back called on empty list."};
+    }
+
+    return *std::prev(end());
+  }
+
+  const_iterator begin() const { return const_iterator{m_head->next[0]}; }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator end() const { return const_iterator{m_head}; }
+
+  const_iterator cend() const { return end(); }
+
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator{end()};
+  }
+
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator{begin()};
+  }
+
+  const_reverse_iterator crend() const { return rend(); }
+
+  // Returns the first element that is not less than value.
+  const_iterator lower_bound(const_reference value) const
+  {
+    return const_iterator{
+      search(value, [this](const value_type& element, const value_type& v) {
+        return m_compare(element, v);
+      })};
+  }
+
+  // Returns the first element that is greater than value.
+  const_iterator upper_bound(const_reference value) const
+  {
+    return const_iterator{
+      search(value, [this](const value_type& element, const value_type& v) {
+        return !m_compare(v, element);
+      })};
+  }
+
+  std::pair<const_iterator, const_iterator> equal_range(
+    const_reference value) const
+  {
+    return {lower_bound(value), upper_bound(value)};
+  }
+
+  const_iterator find(const_reference value) const
+  {
+    const const_iterator it{lower_bound(value)};
+
+    if (it == end() || m_compare(value, *it)) { return end(); }
+
+    return it;
+  }
+
+  bool contains(const_reference value) const { return find(value) != end(); }
+
+  size_type count(const_reference value) const
+  {
+    const auto [first, last]{equal_range(value)};
+    return static_cast<size_type>(std::distance(first, last));
+  }
+
+  // Inserts value after the elements that are equal to it.
+  iterator insert(const_reference value)
+  {
+    Path path{};
+    path.fill(m_head);
+    findPath(value, path);
+    return iterator{link(value, path)};
+  }
+
+  // Merges the elements of [first, last), which should be sorted, in a
+  // single pass over the list: each element is searched for starting from
+  // the position of the one before it. Elements that are out of order are
+  // inserted with a regular search from the head instead.
+  template<typename InputIterator>
+  void insert_sorted(InputIterator first, InputIterator last)
+  {
+    Path path{};
+    path.fill(m_head);
+
+    const value_type* previous{nullptr};
+
+    for (; first != last; ++first) {
+      const value_type& value{*first};
+
+      if (previous != nullptr && m_compare(value, *previous)) {
+        path.fill(m_head);
+      }
+
+      findPath(value, path);
+      NodeBase* node{link(value, path)};
+
+      for (size_type level{0}; level < node->height; ++level) {
+        path[level] = node;
+      }
+
+      previous = &static_cast<Node*>(node)->value;
+    }
+  }
+
+  template<typename Range>
+  void insert_sorted(const Range& range)
+  {
+    insert_sorted(std::begin(range), std::end(range));
+  }
+
+  void pop_back()
+  {
+    if (empty()) { return; }
+
+    erase(std::prev(end()));
+  }
+
+  void pop_front()
+  {
+    if (empty()) { return; }
+
+    erase(begin());
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    NodeBase* node{pos.m_node};
+    NodeBase* next{node->next[0]};
+    Path      path{};
+    path.fill(m_head);
+    findPath(
+      static_cast<Node*>(node)->value,
+      path,
+      [this](const value_type& element, const value_type& value) {
+        return m_compare(element, value);
+      });
+
+    // Only equal elements can be between the lower bound and node.
+    for (size_type level{0}; level < node->height; ++level) {
+      NodeBase* prev{path[level]};
+
+      while (prev->next[level] != node) { prev = prev->next[level]; }
+
+      prev->next[level] = node->next[level];
+    }
+
+    next->prev = node->prev;
+
+    while (m_height > 1 && m_head->next[m_height - 1] == m_head) {
+      --m_height;
+    }
+
+    --m_size;
+    destroyNode(static_cast<Node*>(node));
+    return iterator{next};
+  }
+
+  // Erases all elements equal to value, which may be one of them: the
+  // range is found before anything is erased.
+  size_type erase(const_reference value)
+  {
+    const_iterator       it{lower_bound(value)};
+    const const_iterator last{upper_bound(value)};
+    size_type            elementsRemoved{0};
+
+    while (it != last) {
+      it = erase(it);
+      ++elementsRemoved;
+    }
+
+    return elementsRemoved;
+  }
+
+  template<typename UnaryPredicate>
+  size_type remove_if(UnaryPredicate unaryPredicate)
+  {
+    size_type elementsRemoved{0};
+
+    iterator it{begin()};
+
+    while (it != end()) {
+      if (std::invoke(unaryPredicate, *it)) {
+        it = erase(it);
+        ++elementsRemoved;
+      }
+      else {
+        ++it;
+      }
+    }
+
+    return elementsRemoved;
+  }
+
+  size_type remove(const_reference value) { return erase(value); }
+
+  void clear()
+  {
+    NodeBase* node{m_head->next[0]};
+
+    while (node != m_head) {
+      NodeBase* next{node->next[0]};
+      destroyNode(static_cast<Node*>(node));
+      node = next;
+    }
+
+    std::fill_n(m_head->next, maxHeight, m_head);
+    m_head->prev = m_head;
+    m_size       = 0;
+    m_height     = 1;
+  }
+
+  void swap(this_type& other) noexcept
+  {
+    using std::swap;
+    swap(m_head, other.m_head);
+    swap(m_size, other.m_size);
+    swap(m_height, other.m_height);
+    swap(m_compare, other.m_compare);
+    swap(m_randomState, other.m_randomState);
+  }
+
+private:
+  // Moves every node in path forwards to the last node on its level for which
+  // isBefore(element, value) holds.
+  // The nodes in path have to be before value already; filling path with
+  // m_head starts a regular search from the top, while the path of a
+  // smaller value is a finger that the search can continue from.
+  // The default isBefore finds the position after all equal elements.
+  template<typename IsBefore>
+  void findPath(const value_type& value, Path& path, IsBefore isBefore) const
+  {
+    NodeBase* node{m_head};
+    bool      moved{false};
+
+    for (size_type level{m_height}; level-- > 0;) {
+      // Once the search has moved on a higher level, it is past the node
+      // in path on all lower levels.
+      if (!moved) { node = path[level]; }
+
+      while (node->next[level] != m_head
+             && isBefore(
+               static_cast<Node*>(node->next[level])->value, value)) {
+        node = node->next[level];
+      }
+
+      moved       = moved || node != path[level];
+      path[level] = node;
+    }
+  }
+
+  void findPath(const value_type& value, Path& path) const
+  {
+    findPath(
+      value, path, [this](const value_type& element, const value_type& v) {
+        return !m_compare(v, element);
+      });
+  }
+
+  // Returns the node on the lowest level that is the first one for which
+  // isBefore doesn't hold.
+  template<typename IsBefore>
+  NodeBase* search(const value_type& value, IsBefore isBefore) const
+  {
+    NodeBase* node{m_head};
+
+    for (size_type level{m_height}; level-- > 0;) {
+      while (node->next[level] != m_head
+             && isBefore(
+               static_cast<Node*>(node->next[level])->value, value)) {
+        node = node->next[level];
+      }
+    }
+
+    return node->next[0];
+  }
+
+  NodeBase* link(const value_type& value, Path& path)
+  {
+    const size_type height{randomHeight()};
+    Node*           node{createNode(value, height)};
+
+    if (height > m_height) {
+      for (size_type level{m_height}; level < height; ++level) {
+        path[level] = m_head;
+      }
+
+      m_height = height;
+    }
+
+    for (size_type level{0}; level < height; ++level) {
+      node->next[level]       = path[level]->next[level];
+      path[level]->next[level] = node;
+    }
+
+    node->prev          = path[0];
+    node->next[0]->prev = node;
+    ++m_size;
+    return node;
+  }
+
+  // Geometrically distributed with p = 1/4.
+  size_type randomHeight()
+  {
+    m_randomState ^= m_randomState << 13;
+    m_randomState ^= m_randomState >> 7;
+    m_randomState ^= m_randomState << 17;
+
+    const size_type height{
+      1
+      + static_cast<size_type>(std::countr_zero(m_randomState | (1ULL << 62)))
+          / 2};
+    return std::min(height, maxHeight);
+  }
+
+  static std::size_t linksOffset(std::size_t nodeSize)
+  {
+    constexpr std::size_t alignment{alignof(NodeBase*)};
+    return (nodeSize + alignment - 1) / alignment * alignment;
+  }
+
+  static NodeBase* createNodeBase(size_type height)
+  {
+    const std::size_t offset{linksOffset(sizeof(NodeBase))};
+    void*             memory{
+      ::operator new(offset + height * sizeof(NodeBase*))};
+    NodeBase* node{::new (memory) NodeBase{
+      nullptr,
+      reinterpret_cast<NodeBase**>(static_cast<char*>(memory) + offset),
+      height}};
+    trackAllocation(node);
+    return node;
+  }
+
+  static void destroyNodeBase(NodeBase* node)
+  {
+    trackDeallocation(node);
+    node->~NodeBase();
+    ::operator delete(node);
+  }
+
+  static Node* createNode(const value_type& value, size_type height)
+  {
+    const std::size_t offset{linksOffset(sizeof(Node))};
+    void*             memory{
+      ::operator new(offset + height * sizeof(NodeBase*))};
+    Node* node{nullptr};
+
+    try {
+      node = ::new (memory) Node{
+        {nullptr,
+         reinterpret_cast<NodeBase**>(static_cast<char*>(memory) + offset),
+         height},
+        value};
+    }
+    catch (...) {
+      ::operator delete(memory);
+      throw;
+    }
+
+    trackAllocation(node);
+    return node;
+  }
+
+  static void destroyNode(Node* node)
+  {
+    trackDeallocation(node);
+    node->~Node();
+    ::operator delete(node);
+  }
+
+  NodeBase*     m_head; // also the end
+  size_type     m_size;
+  size_type     m_height; // of the highest node
+  value_compare m_compare;
+  std::uint64_t m_randomState;
+};
+
+template<typename Ty, typename Compare>
+void swap(SortedList<Ty, Compare>& lhs, SortedList<Ty, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+#endif // INCG_SORTED_LIST_HPP
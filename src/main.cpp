@@ -1,20 +1,104 @@
+#include <cctype>
+#include <climits>
 #include <cstdint>
 #include <cstdlib>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <locale>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <ranges>
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "augmented_list.hpp"
+#include "channel.hpp"
+#include "compressed_int_list.hpp"
+#include "executor.hpp"
+#include "linked_hash_list.hpp"
 #include "list.hpp"
+#include "list_format.hpp"
+#include "lru_cache.hpp"
+#include "node_cache.hpp"
+#include "persistent_list.hpp"
+#include "rcu_list.hpp"
+#include "reclaimer.hpp"
+#include "sorted_list.hpp"
 
-std::unordered_set<void*> newed{};
-std::unordered_set<void*> deleted{};
+#ifdef __linux__
+#include <cstdio>
+
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "mapped_list.hpp"
+#endif
+
+// The allocations of a test case that are still alive are attributed to it
+// so that a leak is reported for the test case that caused it, even while
+// other test cases run concurrently.
+struct TestRun {
+  std::size_t allocationCount{0};
+  std::size_t liveAllocationCount{0};
+};
+
+// The test case that the calling thread runs, if any.
+thread_local TestRun* currentTestRun{nullptr};
+
+std::mutex allocationTrackingMutex{};
+
+// Allocations made by threads that don't run a test case themselves, e.g.
+// the worker threads of an executor, are attributed to the test case that
+// runs exclusively.
+TestRun* exclusiveTestRun{nullptr};
+
+std::unordered_map<void*, TestRun*> liveAllocations{};
+
+void recordAllocation(void* pointer)
+{
+  const std::lock_guard<std::mutex> lock{allocationTrackingMutex};
+  TestRun* const                    testRun{
+    currentTestRun != nullptr ? currentTestRun : exclusiveTestRun};
+  liveAllocations.insert_or_assign(pointer, testRun);
+
+  if (testRun != nullptr) {
+    ++testRun->allocationCount;
+    ++testRun->liveAllocationCount;
+  }
+}
+
+void recordDeallocation(void* pointer)
+{
+  const std::lock_guard<std::mutex> lock{allocationTrackingMutex};
+  const auto                        it{liveAllocations.find(pointer)};
+
+  if (it == liveAllocations.end()) { return; }
+
+  if (it->second != nullptr) { --it->second->liveAllocationCount; }
+
+  liveAllocations.erase(it);
+}
+
+// The number of allocations the current test case has made so far.
+std::size_t recordedAllocationCount()
+{
+  const std::lock_guard<std::mutex> lock{allocationTrackingMutex};
+  return currentTestRun->allocationCount;
+}
 
 #ifdef _MSC_VER
 #define FUNCTION __FUNCSIG__
@@ -93,20 +177,29 @@ using TestFunction = void (*)();
 struct TestFunctionWithName {
   TestFunction function;
   std::string  name;
+  bool         exclusive;
 };
 
 std::vector<TestFunctionWithName> testFunctions{};
 
-#define TEST(testName)                                                     \
-  void testName();                                                         \
-  struct testName##Struct {                                                \
-    testName##Struct()                                                     \
-    {                                                                      \
-      testFunctions.push_back(TestFunctionWithName{&testName, #testName}); \
-    }                                                                      \
-  } testName##StructInstance{};                                            \
+#define REGISTER_TEST(testName, isExclusive)                      \
+  void testName();                                                \
+  struct testName##Struct {                                       \
+    testName##Struct()                                            \
+    {                                                             \
+      testFunctions.push_back(                                    \
+        TestFunctionWithName{&testName, #testName, isExclusive}); \
+    }                                                             \
+  } testName##StructInstance{};                                   \
   void testName()
 
+#define TEST(testName) REGISTER_TEST(testName, false)
+
+// For test cases that start threads of their own: they never run
+// concurrently with other test cases, so that the allocations of their
+// threads can be attributed to them.
+#define EXCLUSIVE_TEST(testName) REGISTER_TEST(testName, true)
+
 List<int> makeTestList()
 {
   List<int> list{};
@@ -268,6 +361,199 @@ TEST(shouldThrowAnExceptionWhenIndexIsOutOfBounds)
   }
 }
 
+TEST(shouldAccessElementsWithoutChecksIfConfiguredTo)
+{
+  using UncheckedList = List<int, ListConfig{.access = ListAccess::unchecked}>;
+
+  UncheckedList list{1, 2, 3};
+  list.front() = 0;
+  list.back() += 1;
+  list[1] *= 5;
+
+  const UncheckedList& constList{list};
+  ASSERT_EQ(0, constList.front());
+  ASSERT_EQ(10, constList[1]);
+  ASSERT_EQ(4, constList.back());
+  ASSERT_EQ("List[0, 10, 4]", toString(list));
+}
+
+#ifdef __cpp_lib_expected
+TEST(shouldReturnErrorsFromTheAccessorsIfConfiguredTo)
+{
+  using ExpectedList = List<int, ListConfig{.access = ListAccess::expected}>;
+
+  ExpectedList list{};
+  ASSERT_EQ(true, list.front().error() == ListError::empty);
+  ASSERT_EQ(true, list.back().error() == ListError::empty);
+  ASSERT_EQ(true, list[0].error() == ListError::indexOutOfBounds);
+
+  list.push_back(1);
+  list.push_back(2);
+  list.front()->get() = 5;
+  ASSERT_EQ(5, std::as_const(list).front()->get());
+  ASSERT_EQ(2, list.back()->get());
+  ASSERT_EQ(2, list[1]->get());
+  ASSERT_EQ(true, list[2].error() == ListError::indexOutOfBounds);
+}
+#endif
+
+TEST(shouldWorkWithoutTrackingTheSize)
+{
+  using UntrackedList = List<int, ListConfig{.tracksSize = false}>;
+  static_assert(sizeof(UntrackedList) < sizeof(List<int>));
+
+  UntrackedList list{};
+  ASSERT_EQ(true, list.empty());
+  ASSERT_EQ(0, list.size());
+
+  for (int i{0}; i < 10; ++i) { list.push_back(i); }
+
+  list.erase(list.begin());
+  list.pop_back();
+  ASSERT_EQ(8, list.size());
+  ASSERT_EQ(8, list.back());
+  ASSERT_EQ(5, list[4]);
+
+  UntrackedList other{100, 200};
+  other.splice(
+    std::next(other.begin()), list, list.begin(), std::next(list.begin(), 3));
+  ASSERT_EQ((UntrackedList{100, 1, 2, 3, 200}), other);
+  ASSERT_EQ((UntrackedList{4, 5, 6, 7, 8}), list);
+  ASSERT_NE(list, other);
+
+  list.splice(list.end(), other);
+  list.resize(12, -1);
+  ASSERT_EQ(
+    (UntrackedList{4, 5, 6, 7, 8, 100, 1, 2, 3, 200, -1, -1}), list);
+  list.resize(3);
+  ASSERT_EQ(3, list.size());
+  ASSERT_EQ(true, other.empty());
+
+  try {
+    list[3];
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::out_of_range& ex) {
+    ASSERT_EQ(
+      "List::operator[]: index out of bounds: 3 is >= size() (3)!"s,
+      ex.what());
+  }
+}
+
+TEST(shouldHandNodeChainsFromOneListToAnother)
+{
+  List<std::string> strings{"a", "b", "c"};
+  const auto*       address{&strings.front()};
+  auto              chain{strings.detach_chain()};
+  ASSERT_EQ(true, strings.empty());
+  ASSERT_EQ(false, chain.empty());
+
+  List<std::string> other{"x", "y"};
+  const auto        it{
+    other.adopt_chain(std::next(other.begin()), std::move(chain))};
+  ASSERT_EQ(true, chain.empty());
+  ASSERT_EQ(address, &*it);
+  ASSERT_EQ((List<std::string>{"x", "a", "b", "c", "y"}), other);
+  ASSERT_EQ(5, other.size());
+  ASSERT_EQ(
+    other.end(), other.adopt_chain(other.end(), strings.detach_chain()));
+
+  strings.adopt_chain(strings.begin(), other.detach_chain());
+  strings.push_front("w");
+  ASSERT_EQ((List<std::string>{"w", "x", "a", "b", "c", "y"}), strings);
+  ASSERT_EQ("y", strings.back());
+
+  // The nodes of a chain that isn't adopted are freed.
+  List<int> numbers{1, 2, 3};
+  auto      dropped{numbers.detach_chain()};
+  dropped = numbers.detach_chain();
+
+  using UntrackedList = List<int, ListConfig{.tracksSize = false}>;
+  UntrackedList untracked{1, 2};
+  UntrackedList untrackedOther{3};
+  untrackedOther.adopt_chain(untrackedOther.begin(), untracked.detach_chain());
+  ASSERT_EQ((UntrackedList{1, 2, 3}), untrackedOther);
+}
+
+EXCLUSIVE_TEST(shouldReturnNodesFreedOnAnotherThreadToTheirThread)
+{
+  using CachedList = List<std::string, ListConfig{.cachesNodes = true}>;
+
+  // Not a multiple of the batch size, so that the consumer thread has to
+  // hand the last batch back when it exits.
+  constexpr std::size_t           count{100};
+  CachedList                      produced{};
+  std::vector<const std::string*> addresses{};
+
+  for (std::size_t i{0}; i < count; ++i) {
+    produced.push_back(std::to_string(i));
+    addresses.push_back(&produced.back());
+  }
+
+  std::size_t consumedCount{0};
+  std::thread consumer{
+    [&consumedCount, chain = produced.detach_chain()]() mutable {
+      CachedList consumed{};
+      consumed.adopt_chain(consumed.end(), std::move(chain));
+      consumedCount = consumed.size();
+      consumed.clear();
+    }};
+  consumer.join();
+  ASSERT_EQ(count, consumedCount);
+
+  // The nodes are reused rather than allocated anew.
+  std::vector<const std::string*> reused{};
+
+  for (std::size_t i{0}; i < count; ++i) {
+    produced.push_front("again");
+    reused.push_back(&produced.front());
+  }
+
+  std::ranges::sort(addresses);
+  std::ranges::sort(reused);
+  ASSERT_EQ(true, addresses == reused);
+  ASSERT_EQ(count, produced.size());
+}
+
+EXCLUSIVE_TEST(shouldLimitTheBlocksHandedBackToANodeCache)
+{
+  // Sizes that no list uses, so that no other cache holds blocks of them.
+  using Cache        = NodeCache<72, 8>;
+  using RetiredCache = NodeCache<136, 8>;
+
+  std::vector<void*> blocks(Cache::maxCachedBlocks * 3);
+
+  for (void*& block : blocks) { block = Cache::allocate(); }
+
+  std::thread consumer{[&blocks] {
+    for (void* block : blocks) { Cache::deallocate(block); }
+  }};
+  consumer.join();
+
+  // The consumer's batches beyond the limit were deleted.
+  Cache::deallocate(Cache::allocate());
+  ASSERT_EQ(Cache::maxCachedBlocks, Cache::cached_blocks());
+
+  // The blocks of an exited thread are deleted rather than handed back to
+  // its retired cache, which the next thread reuses.
+  std::vector<void*> orphans(RetiredCache::batchSize * 2);
+  std::thread        producer{[&orphans] {
+    for (void*& block : orphans) { block = RetiredCache::allocate(); }
+  }};
+  producer.join();
+
+  for (void* block : orphans) { RetiredCache::deallocate(block); }
+
+  RetiredCache::flush();
+  std::size_t reusedCount{1};
+  std::thread successor{[&reusedCount] {
+    RetiredCache::deallocate(RetiredCache::allocate());
+    reusedCount = RetiredCache::cached_blocks();
+  }};
+  successor.join();
+  ASSERT_EQ(std::size_t{1}, reusedCount);
+}
+
 TEST(shouldBeAbleToSort)
 {
   List<int> l{};
@@ -291,6 +577,192 @@ TEST(shouldBeAbleToSortInDescendingOrder)
   ASSERT_EQ(expected, l);
 }
 
+TEST(shouldSortStablyWithoutMovingTheElements)
+{
+  using Pair = std::pair<int, int>;
+  List<Pair> list{{3, 0}, {1, 1}, {3, 2}, {2, 3}, {1, 4}, {3, 5}, {2, 6}};
+  const Pair* const first{&list.front()};
+
+  list.sort([](const Pair& lhs, const Pair& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  const List<Pair> expected{
+    {1, 1}, {1, 4}, {2, 3}, {2, 6}, {3, 0}, {3, 2}, {3, 5}};
+  ASSERT_EQ(true, expected == list);
+  ASSERT_EQ(first, &*std::next(list.begin(), 4));
+
+  List<int> empty{};
+  empty.sort();
+  ASSERT_EQ(true, empty.empty());
+
+  List<int> descending{};
+
+  for (int i{1000}; i > 0; --i) { descending.push_back(i % 37); }
+
+  descending.sort();
+  ASSERT_EQ(true, std::is_sorted(descending.begin(), descending.end()));
+  ASSERT_EQ(
+    true,
+    std::is_sorted(descending.rbegin(), descending.rend(), std::greater{}));
+}
+
+TEST(shouldSortByIntegralKeys)
+{
+  using Pair = std::pair<std::int64_t, int>;
+  List<Pair> list{};
+
+  for (int i{0}; i < 1000; ++i) {
+    const std::int64_t key{(i * 7919 % 1000 - 500) * (std::int64_t{1} << 40)};
+    list.push_back(Pair{key / (i % 3 + 1), i});
+  }
+
+  list.sort_by_key([](const Pair& pair) { return pair.first; });
+
+  ASSERT_EQ(1000, list.size());
+  ASSERT_EQ(true, std::is_sorted(list.begin(), list.end()));
+  ASSERT_EQ(
+    true, std::is_sorted(list.rbegin(), list.rend(), std::greater<Pair>{}));
+
+  List<unsigned char> bytes{200, 3, 255, 0, 3, 17};
+  bytes.sort_by_key([](unsigned char byte) { return byte; });
+  ASSERT_EQ((List<unsigned char>{0, 3, 3, 17, 200, 255}), bytes);
+
+  List<int> sameHighBytes{0x1205, 0x1201, 0x1203};
+  sameHighBytes.sort_by_key([](int i) { return i; });
+  ASSERT_EQ((List<int>{0x1201, 0x1203, 0x1205}), sameHighBytes);
+}
+
+TEST(shouldSortByOtherKeys)
+{
+  struct Person {
+    std::string name;
+    int         age;
+
+    bool operator==(const Person&) const = default;
+  };
+
+  List<Person> people{{"Carol", 30}, {"alice", 25}, {"Bob", 30}, {"Dave", 25}};
+  int          calls{0};
+
+  people.sort_by_key([&calls](const Person& person) -> const std::string& {
+    ++calls;
+    return person.name;
+  });
+  ASSERT_EQ(4, calls);
+  ASSERT_EQ("Bob", people.front().name);
+  ASSERT_EQ("alice", people.back().name);
+
+  people.sort_by_key(
+    [](const Person& person) { return person.age; }, std::greater<>{});
+  const List<Person> byAge{
+    {"Bob", 30}, {"Carol", 30}, {"Dave", 25}, {"alice", 25}};
+  ASSERT_EQ(true, byAge == people);
+
+  people.sort_by_key([](const Person& person) {
+    std::string lower{person.name};
+
+    for (char& c : lower) { c = static_cast<char>(std::tolower(c)); }
+
+    return lower;
+  });
+  ASSERT_EQ("alice", people.front().name);
+  ASSERT_EQ("Dave", people.back().name);
+}
+
+TEST(shouldLeaveTheListAsItWasIfAKeyCantBeComputed)
+{
+  List<std::string> list{"b", "a", "c"};
+
+  try {
+    list.sort_by_key([](const std::string& string) {
+      if (string == "c") { throw std::runtime_error{"no key"}; }
+
+      return string;
+    });
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+  }
+
+  ASSERT_EQ((List<std::string>{"b", "a", "c"}), list);
+}
+
+TEST(shouldPartiallySortAList)
+{
+  List<int>  list{7, 3, 9, 1, 8, 4, 2, 6};
+  const int* nine{&*std::next(list.begin(), 2)};
+
+  const List<int>::iterator rest{list.partial_sort(3)};
+
+  ASSERT_EQ((List<int>{1, 2, 3, 7, 9, 8, 4, 6}), list);
+  ASSERT_EQ(7, *rest);
+  ASSERT_EQ(nine, &*std::next(rest));
+
+  ASSERT_EQ(list.begin(), list.partial_sort(0));
+  ASSERT_EQ(list.end(), list.partial_sort(100, std::greater<int>{}));
+  ASSERT_EQ((List<int>{9, 8, 7, 6, 4, 3, 2, 1}), list);
+
+  List<int> large{};
+
+  for (int i{0}; i < 10'000; ++i) { large.push_back(i * 7919 % 10'000); }
+
+  const List<int>::iterator top{large.partial_sort(100, std::greater<int>{})};
+  ASSERT_EQ(10'000, large.size());
+  ASSERT_EQ(9'900, *std::prev(top));
+  ASSERT_EQ(true, std::is_sorted(large.begin(), top, std::greater<int>{}));
+  ASSERT_EQ(
+    true, std::all_of(top, large.end(), [](int i) { return i < 9'900; }));
+}
+
+TEST(shouldSelectTheNthElementOfAList)
+{
+  List<int>                 list{7, 3, 9, 1, 8, 3, 2, 6};
+  const List<int>::iterator nth{list.nth_element(4)};
+
+  ASSERT_EQ(6, *nth);
+  ASSERT_EQ(std::next(list.begin(), 4), nth);
+  ASSERT_EQ(
+    true, std::all_of(list.begin(), nth, [](int i) { return i <= 6; }));
+  ASSERT_EQ(
+    (List<int>{7, 9, 8}),
+    (List<int>{from_range, std::ranges::subrange{std::next(nth), list.end()}}));
+
+  ASSERT_EQ(9, *list.nth_element(0, std::greater<int>{}));
+  ASSERT_EQ(9, list.front());
+
+  try {
+    list.nth_element(8);
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::out_of_range& ex) {
+    ASSERT_EQ(
+      std::string{
+        "List::nth_element: index out of bounds: 8 is >= size() (8)!"},
+      ex.what());
+  }
+}
+
+TEST(shouldPartitionAListStably)
+{
+  List<int>  list{1, 2, 3, 4, 5, 6, 7};
+  const int* four{&*std::next(list.begin(), 3)};
+
+  const List<int>::iterator odd{
+    list.stable_partition([](int i) { return i % 2 == 0; })};
+
+  ASSERT_EQ((List<int>{2, 4, 6, 1, 3, 5, 7}), list);
+  ASSERT_EQ(1, *odd);
+  ASSERT_EQ(four, &*std::next(list.begin()));
+
+  ASSERT_EQ(list.begin(), list.partition([](int i) { return i > 10; }));
+  ASSERT_EQ(list.end(), list.partition([](int i) { return i < 10; }));
+  ASSERT_EQ((List<int>{2, 4, 6, 1, 3, 5, 7}), list);
+
+  List<int> empty{};
+  ASSERT_EQ(empty.end(), empty.partition([](int) { return true; }));
+}
+
 TEST(shouldBeAbleToAddElementsToTheBack)
 {
   List<int> l{};
@@ -534,288 +1006,2562 @@ TEST(shouldBeAbleToSwapLists)
   ASSERT_EQ((List<int>{1, 2, 3, 4}), l2);
 }
 
-TEST(shouldBeAbleToIterate)
+TEST(shouldBeAbleToSpliceLists)
 {
-  const List<int> l{makeTestList()};
+  List<int> l1{1, 2, 3};
+  List<int> l2{10, 20, 30, 40};
 
-  int                       counter{0};
-  List<int>::const_iterator it{l.begin()};
+  l1.splice(std::next(l1.begin()), l2, std::next(l2.begin()));
+  ASSERT_EQ((List<int>{1, 20, 2, 3}), l1);
+  ASSERT_EQ((List<int>{10, 30, 40}), l2);
 
-  while (it != l.end()) {
-    ASSERT_EQ(counter, *it);
-    ++it;
-    ++counter;
-  }
+  l1.splice(l1.end(), l2, l2.begin(), std::prev(l2.end()));
+  ASSERT_EQ((List<int>{1, 20, 2, 3, 10, 30}), l1);
+  ASSERT_EQ((List<int>{40}), l2);
+  ASSERT_EQ(6, l1.size());
+  ASSERT_EQ(1, l2.size());
+
+  l2.splice(l2.begin(), l1);
+  ASSERT_EQ((List<int>{1, 20, 2, 3, 10, 30, 40}), l2);
+  ASSERT_EQ(true, l1.empty());
+  ASSERT_EQ(l1.begin(), l1.end());
+  ASSERT_EQ(7, l2.size());
+
+  l2.splice(l2.begin(), l2, std::prev(l2.end()));
+  l2.splice(l2.end(), l2, std::next(l2.begin()), std::next(l2.begin(), 3));
+  ASSERT_EQ((List<int>{40, 2, 3, 10, 30, 1, 20}), l2);
+  ASSERT_EQ(
+    true,
+    std::equal(
+      l2.rbegin(),
+      l2.rend(),
+      std::make_reverse_iterator(List<int>::const_iterator{l2.end()}),
+      std::make_reverse_iterator(List<int>::const_iterator{l2.begin()})));
 }
 
-TEST(shouldBeAbleToIterateBackwards)
-{
-  const List<int> l{makeTestList()};
+constexpr std::array<int, 6> sortedTable{[] {
+  List<int> list{5, 3, 6, 1, 4, 2};
+  list.sort();
 
-  int                               counter{9};
-  List<int>::const_reverse_iterator it{l.rbegin()};
+  std::array<int, 6> table{};
+  std::copy(list.begin(), list.end(), table.begin());
+  return table;
+}()};
 
-  while (it != l.rend()) {
-    ASSERT_EQ(counter, *it);
-    ++it;
-    --counter;
-  }
+constexpr bool modifyListInConstantExpression()
+{
+  List<int> list{1, 2, 3};
+  list.push_front(0);
+  list.push_back(4);
+  list.insert(std::next(list.begin(), 2), 10);
+  list.erase(std::prev(list.end()));
+  list.remove(2);
+  list[0] = -1;
+
+  List<int> other{list};
+  other.resize(6, 7);
+  list.splice(list.end(), other, std::prev(other.end()));
+  list.swap(other);
+
+  return other == List<int>{-1, 1, 10, 3, 7} && other.size() == 5
+         && other.back() == 7 && other < List<int>{-1, 2} && list == other;
 }
 
-TEST(shouldBeAbleToCompareIterators)
+constexpr bool storeElementsOutOfLineInConstantExpression()
 {
-  List<int> l{makeTestList()};
+  using OutOfLineList = List<int, ListConfig{.outOfLineSize = 1}>;
+  OutOfLineList list{3, 1, 2};
+  list.sort();
+  list.erase(list.begin());
+  list.push_front(0);
 
-  ASSERT_EQ(l.begin(), std::prev(l.end(), 10));
-  ASSERT_EQ(l.cbegin(), std::prev(l.cend(), 10));
-  ASSERT_NE(l.begin(), l.end());
-  ASSERT_NE(l.cbegin(), l.cend());
+  return list == OutOfLineList{0, 2, 3} && list.back() == 3;
 }
 
-TEST(shouldBeAbleToPrintIterators)
+TEST(shouldBeUsableInConstantExpressions)
 {
-  std::ostringstream oss1{};
-  std::ostringstream oss2{};
+  static_assert(sortedTable == std::array<int, 6>{1, 2, 3, 4, 5, 6});
+  static_assert(modifyListInConstantExpression());
+  static_assert(storeElementsOutOfLineInConstantExpression());
+  ASSERT_EQ(6, sortedTable.back());
+}
 
-  List<int> l{makeTestList()};
+TEST(shouldKeepSlabNodesAliveWhileAnyListUsesThem)
+{
+  struct Point {
+    int    x;
+    double y;
+  };
+
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
+
+  // Large enough for the list to span several slabs.
+  SlabList source{};
+
+  for (int i{0}; i < 5000; ++i) { source.push_back(i); }
+
+  SlabList copy{source};
+  SlabList spliced{};
+
+  // A copy takes its nodes from a single slab.
+  ASSERT_EQ(0, copy.layout().gaps);
+  spliced.splice(
+    spliced.end(), copy, std::next(copy.begin(), 100), std::prev(copy.end()));
+  copy.erase(copy.begin());
+  source.clear();
+
+  ASSERT_EQ(1, copy.front());
+  ASSERT_EQ(4999, copy.back());
+  ASSERT_EQ(100, copy.size());
+  ASSERT_EQ(4899, spliced.size());
+  ASSERT_EQ(100, spliced.front());
+  ASSERT_EQ(4998, spliced.back());
+
+  // Erased nodes are reused by later insertions until shrink_to_fit.
+  spliced.remove_if([](int element) { return element % 2 == 0; });
+  spliced.shrink_to_fit();
+
+  for (int i{0}; i < 10; ++i) { spliced.push_front(-i); }
+
+  copy = spliced;
+  ASSERT_EQ(spliced, copy);
+  ASSERT_EQ(-9, copy.front());
+  ASSERT_EQ(4997, copy.back());
+
+  List<Point, ListConfig{.usesSlabs = true}> points{
+    Point{1, 0.5}, Point{2, 1.5}};
+  List<Point, ListConfig{.usesSlabs = true}> pointsCopy{points};
+  points.clear();
+  pointsCopy.push_back(Point{3, 2.5});
+  ASSERT_EQ(3, pointsCopy.size());
+  ASSERT_EQ(2, std::next(pointsCopy.begin())->x);
+  ASSERT_EQ(2.5, pointsCopy.back().y);
+}
 
-  oss1 << l.begin();
-  oss2 << l.cbegin();
+EXCLUSIVE_TEST(shouldReleaseAListOnABackgroundThread)
+{
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
 
-  const std::string str1{oss1.str()};
-  const std::string str2{oss2.str()};
+  Reclaimer reclaimer{};
+  SlabList  list{};
 
-  const std::string expectedStart1{"List::iterator{"};
-  const std::string expectedStart2{"List::const_iterator{"};
+  for (int i{0}; i < 10000; ++i) { list.push_back(i); }
 
-  ASSERT_EQ(true, str1.size() >= expectedStart1.size());
-  ASSERT_EQ(true, str2.size() >= expectedStart2.size());
+  list.remove_if([](int i) { return i % 3 == 0; });
+  list.release_async(reclaimer);
+  ASSERT_EQ(true, list.empty());
+  ASSERT_EQ(list.begin(), list.end());
 
-  const bool beginsWith1{std::equal(
-    expectedStart1.begin(),
-    expectedStart1.end(),
-    str1.begin(),
-    str1.begin() + expectedStart1.size())};
-  const bool beginsWith2{std::equal(
-    expectedStart2.begin(),
-    expectedStart2.end(),
-    str2.begin(),
-    str2.begin() + expectedStart2.size())};
+  list.push_back(1);
+  list.push_front(0);
+  ASSERT_EQ((SlabList{0, 1}), list);
 
-  ASSERT_EQ(true, beginsWith1);
-  ASSERT_EQ(true, beginsWith2);
+  List<std::string> strings{"a", "b", "c"};
+  strings.release_async(reclaimer);
+  strings.release_async(reclaimer);
+  ASSERT_EQ(0, strings.size());
+  ASSERT_EQ("List[]", toString(strings));
+
+  reclaimer.wait();
 }
 
-TEST(shouldBeAbleToPostfixIncrementIterators)
+TEST(shouldClearAListIncrementally)
 {
-  List<int> l{makeTestList()};
+  List<int, ListConfig{.usesSlabs = true}> list{};
 
-  List<int>::iterator       it{l.begin()};
-  List<int>::const_iterator cit{l.begin()};
+  for (int i{0}; i < 1000; ++i) { list.push_back(i); }
 
-  List<int>::iterator it2{it++};
-  ASSERT_EQ(l.begin(), it2);
-  ASSERT_EQ(std::next(l.begin()), it);
+  list.remove_if([](int i) { return i < 10; });
 
-  List<int>::const_iterator cit2{cit++};
-  ASSERT_EQ(l.cbegin(), cit2);
-  ASSERT_EQ(std::next(l.cbegin()), cit);
+  ASSERT_EQ(false, list.clear_incremental(100));
+  ASSERT_EQ(890, list.size());
+  ASSERT_EQ(110, list.front());
+
+  int calls{1};
+
+  do {
+    ++calls;
+  } while (!list.clear_incremental(100));
+
+  // 990 elements, then the 10 erased nodes that were kept for reuse.
+  ASSERT_EQ(10, calls);
+  ASSERT_EQ(true, list.empty());
+  ASSERT_EQ(true, list.clear_incremental(100));
+
+  List<std::string> strings{"a", "b", "c", "d", "e"};
+  ASSERT_EQ(false, strings.clear_incremental(2));
+  ASSERT_EQ((List<std::string>{"c", "d", "e"}), strings);
+  ASSERT_EQ(false, strings.clear_incremental(2));
+  ASSERT_EQ(true, strings.clear_incremental(2));
+  strings.push_back("f");
+  ASSERT_EQ("f", strings.front());
 }
 
-TEST(shouldBeAbleToPrefixDecrementIterators)
+// Inserts count elements at scattered positions, so that the nodes end up
+// linked in a different order than they were allocated in.
+template<typename ListType, typename MakeElement>
+ListType makeFragmentedList(int count, MakeElement makeElement)
 {
-  List<int> l{makeTestList()};
+  ListType list{};
 
-  List<int>::iterator       it{l.end()};
-  List<int>::const_iterator cit{l.end()};
+  for (int i{0}; i < count; ++i) {
+    list.insert(
+      std::next(list.begin(), i * 7919 % (i + 1)), makeElement(i));
+  }
 
-  List<int>::iterator       it2{--it};
-  List<int>::const_iterator cit2{--cit};
+  return list;
+}
 
-  const List<int>::iterator       lastElemIt{std::prev(l.end())};
-  const List<int>::const_iterator lastElemCit{std::prev(l.cend())};
+TEST(shouldDefragmentAList)
+{
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
+
+  SlabList list{makeFragmentedList<SlabList>(3000, [](int i) { return i; })};
+  const std::vector<int> elements(list.begin(), list.end());
+
+  const SlabList::Layout before{list.defragment()};
+  ASSERT_EQ(3000, before.nodes);
+  ASSERT_EQ(true, before.gaps > 1000);
+  ASSERT_EQ(true, before.fragmentation() > 0.3);
+  ASSERT_EQ(0, list.layout().gaps);
+  ASSERT_EQ(0.0, list.layout().fragmentation());
+  ASSERT_EQ(
+    true,
+    std::equal(list.begin(), list.end(), elements.begin(), elements.end()));
+
+  // A sequential list is left alone.
+  ASSERT_EQ(0, list.defragment().gaps);
+
+  List<std::string> strings{makeFragmentedList<List<std::string>>(
+    500, [](int i) { return std::to_string(i); })};
+  const std::vector<std::string> stringElements(strings.begin(), strings.end());
+  ASSERT_EQ(true, strings.defragment().gaps > 100);
+  ASSERT_EQ(
+    true,
+    std::equal(
+      strings.begin(),
+      strings.end(),
+      stringElements.begin(),
+      stringElements.end()));
+
+  SlabList empty{};
+  ASSERT_EQ(0, empty.defragment().nodes);
+  ASSERT_EQ(0.0, empty.layout().fragmentation());
+}
 
-  ASSERT_EQ(lastElemIt, it);
-  ASSERT_EQ(lastElemIt, it2);
+// Its copy constructor throws once copiesLeft copies have been made; it has
+// no move constructor.
+struct CopyCounted {
+  // Per thread, since the test cases that use it may run concurrently.
+  static inline thread_local int copiesLeft{INT_MAX};
 
-  ASSERT_EQ(lastElemCit, cit);
-  ASSERT_EQ(lastElemCit, cit2);
-}
+  CopyCounted() : value{0} {}
 
-TEST(shouldBeAbleToPostfixDecrementIterators)
+  explicit CopyCounted(int i) : value{i} {}
+
+  CopyCounted(const CopyCounted& other) : value{other.value}
+  {
+    if (copiesLeft-- == 0) { throw std::runtime_error{"copy failed"}; }
+  }
+
+  CopyCounted& operator=(const CopyCounted&) = default;
+
+  int value;
+};
+
+TEST(shouldKeepAllElementsIfDefragmentingThrows)
 {
-  List<int> l{makeTestList()};
+  List<CopyCounted> list{makeFragmentedList<List<CopyCounted>>(
+    200, [](int i) { return CopyCounted{i}; })};
+  std::vector<int> elements{};
 
-  List<int>::iterator       it{l.end()};
-  List<int>::const_iterator cit{l.end()};
+  for (const CopyCounted& element : list) { elements.push_back(element.value); }
 
-  List<int>::iterator       it2{it--};
-  List<int>::const_iterator cit2{cit--};
+  CopyCounted::copiesLeft = 100;
 
-  const List<int>::iterator       lastElemIt{std::prev(l.end())};
-  const List<int>::const_iterator lastElemCit{std::prev(l.cend())};
+  try {
+    list.defragment();
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    CopyCounted::copiesLeft = INT_MAX;
+  }
 
-  ASSERT_EQ(lastElemIt, it);
-  ASSERT_EQ(l.end(), it2);
+  ASSERT_EQ(200, list.size());
+  ASSERT_EQ(
+    true,
+    std::ranges::equal(
+      list, elements, {}, [](const CopyCounted& c) { return c.value; }));
 
-  ASSERT_EQ(lastElemCit, cit);
-  ASSERT_EQ(l.cend(), cit2);
+  // Elements stored out of line are copied into new allocations after the
+  // nodes of their slab list have been.
+  using OutOfLineList
+    = List<CopyCounted, ListConfig{.usesSlabs = true, .outOfLineSize = 1}>;
+  OutOfLineList outOfLine{makeFragmentedList<OutOfLineList>(
+    200, [](int i) { return CopyCounted{i}; })};
+  CopyCounted::copiesLeft = 100;
+
+  try {
+    outOfLine.defragment();
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    CopyCounted::copiesLeft = INT_MAX;
+  }
+
+  ASSERT_EQ(200, outOfLine.size());
+  ASSERT_EQ(
+    true,
+    std::ranges::equal(
+      outOfLine, elements, {}, [](const CopyCounted& c) { return c.value; }));
 }
 
-TEST(shouldBeAbleToPrintAList)
+TEST(shouldStoreLargeElementsOutOfLine)
 {
-  const List<int>    l{makeTestList()};
-  std::ostringstream oss{};
-  oss << l;
-  const std::string actual{oss.str()};
-  ASSERT_EQ("List[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]"s, actual);
+  struct Record {
+    std::string           name;
+    std::array<char, 256> payload;
+
+    bool operator==(const Record&) const = default;
+  };
+
+  // Holding nothing but the links, the nodes fit into slabs, which may
+  // come from an arena.
+  using RecordList
+    = List<Record, ListConfig{.usesSlabs = true, .outOfLineSize = 256}>;
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+  HugePageArena arena{1};
+  RecordList    records{arena};
+#else
+  RecordList records{};
+#endif
 
-  const List<int>    empty{};
-  std::ostringstream oss2{};
-  oss2 << empty;
-  ASSERT_EQ("List[]", oss2.str());
+  for (int i{0}; i < 1000; ++i) {
+    records.push_back(Record{std::to_string(i), {}});
+  }
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+  // The slabs of an arena are adjacent.
+  ASSERT_EQ(0, records.layout().gaps);
+#endif
+  ASSERT_EQ("999", records.back().name);
+
+  records.remove_if(
+    [](const Record& record) { return record.name.size() < 3; });
+  ASSERT_EQ(900, records.size());
+
+  records.sort(
+    [](const Record& lhs, const Record& rhs) { return lhs.name > rhs.name; });
+  ASSERT_EQ("999", records.front().name);
+  ASSERT_EQ("100", records.back().name);
+
+  RecordList copy{records};
+  ASSERT_EQ(true, copy == records);
+  copy.erase(copy.begin());
+  copy.insert(copy.begin(), Record{"first", {}});
+  copy.front().payload[0] = 'x';
+  ASSERT_EQ(false, copy == records);
+
+  records.splice(records.begin(), copy, copy.begin());
+  ASSERT_EQ('x', records.front().payload[0]);
+  ASSERT_EQ(901, records.size());
+  ASSERT_EQ("998", copy.front().name);
+
+  // Defragmenting moves the elements along with the nodes.
+  const Record* const       front{&records.front()};
+  const std::vector<Record> elements(records.begin(), records.end());
+  records.defragment();
+  ASSERT_EQ(true, front != &records.front());
+  ASSERT_EQ(
+    true,
+    std::equal(
+      records.begin(), records.end(), elements.begin(), elements.end()));
+
+  ASSERT_EQ(false, records.clear_incremental(500));
+
+  while (!records.clear_incremental(500)) {}
+
+  ASSERT_EQ(true, records.empty());
 }
 
-TEST(shouldBeAbleToCompareListsForEquality)
+TEST(shouldDefragmentAListInSteps)
+{
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
+
+  SlabList list{makeFragmentedList<SlabList>(2000, [](int i) { return i; })};
+  const std::vector<int> elements(list.begin(), list.end());
+
+  for (auto it{list.cbegin()}; it != list.cend();) {
+    it = list.defragment(it, 128);
+  }
+
+  ASSERT_EQ(0, list.layout().gaps);
+  ASSERT_EQ(
+    true,
+    std::equal(list.begin(), list.end(), elements.begin(), elements.end()));
+
+  // Modifying the list between the steps.
+  SlabList         modified{makeFragmentedList<SlabList>(2000, [](int i) {
+    return i;
+  })};
+  std::vector<int> model(modified.begin(), modified.end());
+
+  for (auto it{modified.cbegin()}; it != modified.cend();) {
+    it = modified.defragment(it, 100);
+    modified.push_front(-1);
+    modified.erase(std::next(modified.begin()));
+    model.insert(model.begin(), -1);
+    model.erase(std::next(model.begin()));
+  }
+
+  ASSERT_EQ(
+    true,
+    std::equal(modified.begin(), modified.end(), model.begin(), model.end()));
+  ASSERT_EQ(true, modified.layout().fragmentation() < 0.1);
+}
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+TEST(shouldTakeNodesFromAHugePageArena)
+{
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
+
+  HugePageArena arena{1};
+  ASSERT_EQ(0, arena.reserved());
+
+  SlabList other{1, 2, 3};
+
+  {
+    SlabList list{arena};
+
+    for (int i{0}; i < 50'000; ++i) { list.push_back(i); }
+
+    // Consecutive slabs are adjacent in the arena.
+    ASSERT_EQ(0, list.layout().gaps);
+    ASSERT_EQ(HugePageArena::hugePageSize, arena.reserved());
+
+    SlabList copy{list};
+    ASSERT_EQ(list, copy);
+    ASSERT_EQ(2 * HugePageArena::hugePageSize, arena.reserved());
+
+    other.splice(other.end(), list, list.begin());
+  }
+
+  // The slabs of the destroyed lists are reused.
+  SlabList list{arena};
+
+  for (int i{0}; i < 50'000; ++i) { list.push_back(i); }
+
+  ASSERT_EQ(2 * HugePageArena::hugePageSize, arena.reserved());
+  ASSERT_EQ((SlabList{1, 2, 3, 0}), other);
+
+  // Inserted ranges take their nodes from the arena too.
+  HugePageArena rangeArena{1};
+  SlabList      ranges{rangeArena};
+
+  for (int i{0}; i < 20'000; i += 2) {
+    ranges.append_range(std::array<int, 2>{i, i + 1});
+  }
+
+  ASSERT_EQ(20'000, ranges.size());
+  ASSERT_EQ(HugePageArena::hugePageSize, rangeArena.reserved());
+  ASSERT_EQ(0, ranges.layout().gaps);
+
+  // Freed blocks are only reused for allocations of the same alignment.
+  HugePageArena blockArena{1};
+  blockArena.allocate(8, 8);
+  void* const block{blockArena.allocate(64, 8)};
+  blockArena.deallocate(block, 64, 8);
+  void* const aligned{blockArena.allocate(64, 4096)};
+  ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(aligned) % 4096);
+  ASSERT_EQ(block, blockArena.allocate(64, 8));
+}
+#endif
+
+EXCLUSIVE_TEST(shouldBuildAListOnSeveralThreads)
+{
+  std::vector<int> numbers(100'000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+
+  const List<int> list(parallel, numbers.begin(), numbers.end(), 4);
+  ASSERT_EQ(numbers.size(), list.size());
+  ASSERT_EQ(true, std::ranges::equal(numbers, list));
+
+  const std::vector<std::string> strings{"a", "b", "c"};
+  List<std::string>              stringList{"d"};
+  stringList.assign(parallel, strings.begin(), strings.end(), 4);
+  ASSERT_EQ((List<std::string>{"a", "b", "c"}), stringList);
+
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+  HugePageArena                            arena{};
+  List<int, ListConfig{.usesSlabs = true}> slabList{arena};
+#else
+  List<int, ListConfig{.usesSlabs = true}> slabList{};
+#endif
+  slabList.assign(parallel, numbers.rbegin(), numbers.rend(), 3);
+  ASSERT_EQ(numbers.size(), slabList.size());
+  ASSERT_EQ(0, slabList.back());
+#ifdef LIST_HAS_HUGE_PAGE_ARENA
+  ASSERT_EQ(false, arena.reserved() == 0);
+#endif
+
+  const auto failing{
+    std::views::iota(0, 100'000) | std::views::transform([](int i) {
+      if (i == 70'000) { throw std::runtime_error{"failed"}; }
+
+      return i;
+    })};
+
+  try {
+    slabList.assign(parallel, failing.begin(), failing.end(), 3);
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    ASSERT_EQ(numbers.size(), slabList.size());
+    ASSERT_EQ(0, slabList.back());
+  }
+}
+
+TEST(shouldMaintainTheAggregatesOfAnAugmentedList)
+{
+  using Numbers
+    = AugmentedList<int, SumMonoid<int>, MinMonoid<int>, MaxMonoid<int>>;
+  Numbers numbers{5, 3, 8};
+  ASSERT_EQ(16, numbers.aggregate<SumMonoid<int>>());
+  ASSERT_EQ(3, numbers.aggregate<MinMonoid<int>>());
+  ASSERT_EQ(8, numbers.aggregate<MaxMonoid<int>>());
+
+  numbers.push_front(1);
+  numbers.push_back(10);
+  ASSERT_EQ(27, numbers.aggregate<SumMonoid<int>>());
+  ASSERT_EQ(1, numbers.aggregate<MinMonoid<int>>());
+
+  numbers.pop_front();
+  numbers.erase(std::next(numbers.begin(), 2));
+  ASSERT_EQ(18, numbers.aggregate<SumMonoid<int>>());
+  ASSERT_EQ(3, numbers.aggregate<MinMonoid<int>>());
+  ASSERT_EQ(10, numbers.aggregate<MaxMonoid<int>>());
+
+  numbers.insert(std::next(numbers.begin()), -2);
+  numbers.pop_back();
+  ASSERT_EQ((Numbers{5, -2, 3}), numbers);
+  ASSERT_EQ(6, numbers.aggregate<SumMonoid<int>>());
+  ASSERT_EQ(-2, numbers.aggregate<MinMonoid<int>>());
+  ASSERT_EQ(5, numbers.aggregate<MaxMonoid<int>>());
+  ASSERT_EQ("AugmentedList[5, -2, 3]", toString(numbers));
+
+  numbers.clear();
+  ASSERT_EQ(0, numbers.aggregate<SumMonoid<int>>());
+  ASSERT_EQ(INT_MAX, numbers.aggregate<MinMonoid<int>>());
+
+  // Neither commutative nor invertible.
+  struct Concatenation {
+    using value_type = std::string;
+
+    static value_type identity() { return ""; }
+
+    static value_type lift(const std::string& element) { return element; }
+
+    static value_type combine(const value_type& lhs, const value_type& rhs)
+    {
+      return lhs + rhs;
+    }
+  };
+
+  AugmentedList<std::string, Concatenation> words{"b", "c"};
+  words.push_front("a");
+  ASSERT_EQ("abc", words.aggregate<Concatenation>());
+  words.insert(std::next(words.begin()), "x");
+  ASSERT_EQ("axbc", words.aggregate<Concatenation>());
+  words.pop_front();
+  words.push_back("d");
+  ASSERT_EQ("xbcd", words.aggregate<Concatenation>());
+}
+
+TEST(shouldCompareAugmentedListsByTheirHashes)
+{
+  using Numbers = AugmentedList<int>;
+  const Numbers numbers{1, 2, 3};
+  Numbers       reversed{3, 2, 1};
+  ASSERT_NE(numbers.hash(), reversed.hash());
+  ASSERT_NE(numbers, reversed);
+
+  reversed.pop_front();
+  reversed.pop_back();
+  reversed.push_front(1);
+  reversed.push_back(3);
+  ASSERT_EQ(numbers.hash(), reversed.hash());
+  ASSERT_EQ(numbers, reversed);
+
+  Numbers other{1, 3};
+  other.insert(std::next(other.begin()), 2);
+  ASSERT_EQ(numbers.hash(), other.hash());
+  other.erase(std::next(other.begin()));
+  other.insert(std::next(other.begin()), 4);
+  ASSERT_NE(numbers, other);
+  ASSERT_NE(numbers, (Numbers{1, 2}));
+
+  other.clear();
+  ASSERT_EQ(Numbers{}.hash(), other.hash());
+
+  AugmentedList<std::string> strings{"a", "b"};
+  strings.pop_back();
+  ASSERT_EQ((AugmentedList<std::string>{"a"}), strings);
+}
+
+EXCLUSIVE_TEST(shouldRecomputeTheAggregatesOfAnAugmentedListOnSeveralThreads)
+{
+  using Numbers = AugmentedList<int, MinMonoid<int>>;
+  Numbers numbers{};
+
+  for (int i{0}; i < 10'000; ++i) { numbers.push_back(i); }
+
+  // Both the minimum and the hash have to be recomputed.
+  numbers.erase(std::next(numbers.begin(), 5'000));
+  numbers.erase(numbers.begin());
+  const Numbers copy{numbers};
+
+  std::atomic<int>         mismatches{0};
+  std::vector<std::thread> readers{};
+
+  for (int i{0}; i < 4; ++i) {
+    readers.emplace_back([&numbers, &copy, &mismatches] {
+      if (
+        numbers.aggregate<MinMonoid<int>>() != 1 || !(numbers == copy)
+        || numbers.hash() != copy.hash()) {
+        ++mismatches;
+      }
+    });
+  }
+
+  for (std::thread& reader : readers) { reader.join(); }
+
+  ASSERT_EQ(0, mismatches.load());
+  ASSERT_EQ(1, copy.aggregate<MinMonoid<int>>());
+
+  // Moving takes the elements over instead of copying them.
+  const std::size_t allocationsBefore{recordedAllocationCount()};
+  Numbers           moved{std::move(numbers)};
+  numbers = std::move(moved);
+  ASSERT_EQ(true, recordedAllocationCount() - allocationsBefore < 10);
+  ASSERT_EQ(9'998, numbers.size());
+  ASSERT_EQ(1, numbers.aggregate<MinMonoid<int>>());
+  ASSERT_EQ(true, numbers == copy);
+  ASSERT_EQ(true, moved.empty());
+}
+
+TEST(shouldCompressIncreasingIntegers)
+{
+  static_assert(
+    std::bidirectional_iterator<CompressedIntList<>::const_iterator>);
+
+  CompressedIntList<>       ids{};
+  std::vector<std::int64_t> model{};
+  std::int64_t              id{1'000'000'000'000};
+
+  for (std::int64_t i{0}; i < 100'000; ++i) {
+    id += i % 100 == 0 ? 100'000 + i : i % 7 + 1;
+    ids.push_back(id);
+    model.push_back(id);
+  }
+
+  ASSERT_EQ(model.size(), ids.size());
+  ASSERT_EQ(model.front(), ids.front());
+  ASSERT_EQ(model.back(), ids.back());
+  ASSERT_EQ(
+    true, std::equal(ids.begin(), ids.end(), model.begin(), model.end()));
+  ASSERT_EQ(
+    true,
+    std::equal(ids.rbegin(), ids.rend(), model.rbegin(), model.rend()));
+  ASSERT_EQ(true, ids.memory_usage() < model.size() * 2);
+
+  std::vector<std::int64_t> decoded(ids.size());
+  ASSERT_EQ(true, ids.decode(decoded.begin()) == decoded.end());
+  ASSERT_EQ(true, decoded == model);
+
+  const CompressedIntList<int> extremes{
+    INT_MIN, INT_MAX, 0, -1, INT_MAX, INT_MIN, 5};
+  ASSERT_EQ(
+    "CompressedIntList[-2147483648, 2147483647, 0, -1, 2147483647, "
+    "-2147483648, 5]",
+    toString(extremes));
+  ASSERT_EQ("CompressedIntList[]", toString(CompressedIntList<>{}));
+}
+
+TEST(shouldInsertAndEraseInACompressedIntList)
+{
+  CompressedIntList<>       list{};
+  std::vector<std::int64_t> model{};
+  std::uint64_t             random{42};
+
+  for (int i{0}; i < 20'000; ++i) {
+    random = random * 6364136223846793005 + 1442695040888963407;
+    const std::size_t  index{model.empty() ? 0 : (random >> 33) % model.size()};
+    const std::int64_t value{static_cast<std::int64_t>(random)
+                             >> ((random >> 20) % 64)};
+
+    if (model.size() > 100 && (random >> 13) % 3 == 0) {
+      const auto next{list.erase(std::next(list.begin(), index))};
+      model.erase(model.begin() + static_cast<std::ptrdiff_t>(index));
+      ASSERT_EQ(
+        static_cast<std::ptrdiff_t>(index),
+        std::distance(list.begin(), next));
+    }
+    else {
+      const auto inserted{list.insert(std::next(list.begin(), index), value)};
+      model.insert(model.begin() + static_cast<std::ptrdiff_t>(index), value);
+      ASSERT_EQ(value, *inserted);
+      ASSERT_EQ(
+        static_cast<std::ptrdiff_t>(index),
+        std::distance(list.begin(), inserted));
+    }
+  }
+
+  ASSERT_EQ(model.size(), list.size());
+  ASSERT_EQ(
+    true, std::equal(list.begin(), list.end(), model.begin(), model.end()));
+  ASSERT_EQ(
+    true,
+    std::equal(list.rbegin(), list.rend(), model.rbegin(), model.rend()));
+
+  while (!list.empty()) {
+    ASSERT_EQ(model.back(), list.back());
+    list.pop_back();
+    model.pop_back();
+  }
+
+  ASSERT_EQ(list.end(), list.begin());
+
+  try {
+    list.pop_back();
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::out_of_range& ex) {
+    ASSERT_EQ(
+      std::string{"CompressedIntList::pop_back called on empty list."},
+      ex.what());
+  }
+}
+
+TEST(shouldCompareArithmeticListsOfAnyLength)
+{
+  for (int size{0}; size < 10; ++size) {
+    List<double> l1{};
+
+    for (int i{0}; i < size; ++i) { l1.push_back(i); }
+
+    List<double> l2{l1};
+    ASSERT_EQ(l1, l2);
+    ASSERT_EQ(false, l1 < l2);
+
+    l2.push_back(size);
+    ASSERT_NE(l1, l2);
+    ASSERT_EQ(true, l1 < l2);
+
+    for (int i{0}; i < size; ++i) {
+      List<double> l3{l1};
+      *std::next(l3.begin(), i) += 0.5;
+      ASSERT_NE(l1, l3);
+      ASSERT_EQ(true, l1 < l3);
+      ASSERT_EQ(true, l3 > l1);
+    }
+  }
+}
+
+TEST(shouldBeAbleToIterate)
+{
+  const List<int> l{makeTestList()};
+
+  int                       counter{0};
+  List<int>::const_iterator it{l.begin()};
+
+  while (it != l.end()) {
+    ASSERT_EQ(counter, *it);
+    ++it;
+    ++counter;
+  }
+}
+
+TEST(shouldBeAbleToIterateBackwards)
+{
+  const List<int> l{makeTestList()};
+
+  int                               counter{9};
+  List<int>::const_reverse_iterator it{l.rbegin()};
+
+  while (it != l.rend()) {
+    ASSERT_EQ(counter, *it);
+    ++it;
+    --counter;
+  }
+}
+
+TEST(shouldBeAbleToCompareIterators)
+{
+  List<int> l{makeTestList()};
+
+  ASSERT_EQ(l.begin(), std::prev(l.end(), 10));
+  ASSERT_EQ(l.cbegin(), std::prev(l.cend(), 10));
+  ASSERT_NE(l.begin(), l.end());
+  ASSERT_NE(l.cbegin(), l.cend());
+}
+
+TEST(shouldBeAbleToPrintIterators)
+{
+  std::ostringstream oss1{};
+  std::ostringstream oss2{};
+
+  List<int> l{makeTestList()};
+
+  oss1 << l.begin();
+  oss2 << l.cbegin();
+
+  const std::string str1{oss1.str()};
+  const std::string str2{oss2.str()};
+
+  const std::string expectedStart1{"List::iterator{"};
+  const std::string expectedStart2{"List::const_iterator{"};
+
+  ASSERT_EQ(true, str1.size() >= expectedStart1.size());
+  ASSERT_EQ(true, str2.size() >= expectedStart2.size());
+
+  const bool beginsWith1{std::equal(
+    expectedStart1.begin(),
+    expectedStart1.end(),
+    str1.begin(),
+    str1.begin() + expectedStart1.size())};
+  const bool beginsWith2{std::equal(
+    expectedStart2.begin(),
+    expectedStart2.end(),
+    str2.begin(),
+    str2.begin() + expectedStart2.size())};
+
+  ASSERT_EQ(true, beginsWith1);
+  ASSERT_EQ(true, beginsWith2);
+}
+
+TEST(shouldBeAbleToPostfixIncrementIterators)
+{
+  List<int> l{makeTestList()};
+
+  List<int>::iterator       it{l.begin()};
+  List<int>::const_iterator cit{l.begin()};
+
+  List<int>::iterator it2{it++};
+  ASSERT_EQ(l.begin(), it2);
+  ASSERT_EQ(std::next(l.begin()), it);
+
+  List<int>::const_iterator cit2{cit++};
+  ASSERT_EQ(l.cbegin(), cit2);
+  ASSERT_EQ(std::next(l.cbegin()), cit);
+}
+
+TEST(shouldBeAbleToPrefixDecrementIterators)
+{
+  List<int> l{makeTestList()};
+
+  List<int>::iterator       it{l.end()};
+  List<int>::const_iterator cit{l.end()};
+
+  List<int>::iterator       it2{--it};
+  List<int>::const_iterator cit2{--cit};
+
+  const List<int>::iterator       lastElemIt{std::prev(l.end())};
+  const List<int>::const_iterator lastElemCit{std::prev(l.cend())};
+
+  ASSERT_EQ(lastElemIt, it);
+  ASSERT_EQ(lastElemIt, it2);
+
+  ASSERT_EQ(lastElemCit, cit);
+  ASSERT_EQ(lastElemCit, cit2);
+}
+
+TEST(shouldBeAbleToPostfixDecrementIterators)
+{
+  List<int> l{makeTestList()};
+
+  List<int>::iterator       it{l.end()};
+  List<int>::const_iterator cit{l.end()};
+
+  List<int>::iterator       it2{it--};
+  List<int>::const_iterator cit2{cit--};
+
+  const List<int>::iterator       lastElemIt{std::prev(l.end())};
+  const List<int>::const_iterator lastElemCit{std::prev(l.cend())};
+
+  ASSERT_EQ(lastElemIt, it);
+  ASSERT_EQ(l.end(), it2);
+
+  ASSERT_EQ(lastElemCit, cit);
+  ASSERT_EQ(l.cend(), cit2);
+}
+
+TEST(shouldModelTheRangesConcepts)
+{
+  static_assert(std::bidirectional_iterator<List<int>::iterator>);
+  static_assert(std::bidirectional_iterator<List<int>::const_iterator>);
+  static_assert(std::ranges::bidirectional_range<List<int>>);
+  static_assert(std::ranges::bidirectional_range<const List<int>>);
+  static_assert(std::ranges::common_range<List<int>>);
+  static_assert(std::ranges::sized_range<const List<int>>);
+  static_assert(std::ranges::output_range<List<int>, int>);
+
+  List<int>::iterator       it{};
+  List<int>::const_iterator cit{};
+  ASSERT_EQ(cit, List<int>::const_iterator{it});
+
+  List<int> list{3, 1, 2};
+  ASSERT_EQ(3, std::ranges::size(list));
+  ASSERT_EQ(std::next(list.begin()), std::ranges::find(list, 1));
+  ASSERT_EQ(3, std::ranges::max(list));
+
+  std::ranges::reverse(list);
+  ASSERT_EQ((List<int>{2, 1, 3}), list);
+
+  const List<int> reversed(from_range, list | std::views::reverse);
+  ASSERT_EQ((List<int>{3, 1, 2}), reversed);
+}
+
+TEST(shouldRunViewPipelinesOverAListWithoutAllocating)
+{
+  // A filter_view caches its begin, so it can't be iterated through const.
+  const List<int> list{makeTestList()};
+  auto            squaresOfEvens{
+    list | std::views::filter([](int i) { return i % 2 == 0; })
+    | std::views::transform([](int i) { return i * i; })};
+
+  const std::size_t allocationsBefore{recordedAllocationCount()};
+  int               sum{0};
+
+  for (int square : squaresOfEvens) { sum += square; }
+
+  ASSERT_EQ(120, sum);
+  ASSERT_EQ(
+    true,
+    std::ranges::equal(squaresOfEvens, (std::array<int, 5>{0, 4, 16, 36, 64})));
+  ASSERT_EQ(allocationsBefore, recordedAllocationCount());
+
+  const List<int> materialized(from_range, squaresOfEvens);
+  ASSERT_EQ((List<int>{0, 4, 16, 36, 64}), materialized);
+}
+
+TEST(shouldBeAbleToInsertRanges)
+{
+  List<int>              list{1, 5};
+  const std::vector<int> middle{2, 3, 4};
+
+  const auto it{list.insert_range(std::next(list.begin()), middle)};
+  ASSERT_EQ(2, *it);
+  ASSERT_EQ((List<int>{1, 2, 3, 4, 5}), list);
+
+  ASSERT_EQ(list.end(), list.insert_range(list.end(), std::vector<int>{}));
+
+  list.append_range(std::views::iota(6, 8));
+  list.prepend_range(std::array<int, 2>{-1, 0});
+  ASSERT_EQ((List<int>{-1, 0, 1, 2, 3, 4, 5, 6, 7}), list);
+
+  // A range that fails halfway through doesn't insert anything.
+  const auto failing{std::views::iota(0, 5) | std::views::transform([](int i) {
+                       if (i == 3) { throw std::runtime_error{"failed"}; }
+
+                       return i;
+                     })};
+
+  try {
+    list.append_range(failing);
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    ASSERT_EQ(9, list.size());
+    ASSERT_EQ(7, list.back());
+  }
+
+  const char* const       words[]{"a", "b"};
+  const List<std::string> strings(from_range, words);
+  ASSERT_EQ((List<std::string>{"a", "b"}), strings);
+
+  // The nodes come from the list, so every range doesn't take a slab of its
+  // own; only the boundaries between the slabs of the list are gaps.
+  List<int, ListConfig{.usesSlabs = true}> slabList{};
+
+  for (int i{0}; i < 10'000; i += 2) {
+    slabList.append_range(std::array<int, 2>{i, i + 1});
+  }
+
+  ASSERT_EQ(10'000, slabList.size());
+  ASSERT_EQ(9'999, slabList.back());
+  ASSERT_EQ(true, slabList.layout().gaps < 10);
+}
+
+TEST(shouldMergeASortedBatchIntoASortedList)
+{
+  List<int> list{1, 3, 5, 7};
+  list.insert_batch_sorted(std::vector<int>{0, 3, 4, 8, 9});
+  ASSERT_EQ((List<int>{0, 1, 3, 3, 4, 5, 7, 8, 9}), list);
+  ASSERT_EQ(9, list.size());
+
+  // Elements that are out of order are still inserted where they belong.
+  list.insert_batch_sorted(std::views::iota(5, 7) | std::views::reverse);
+  ASSERT_EQ((List<int>{0, 1, 3, 3, 4, 5, 5, 6, 7, 8, 9}), list);
+
+  // Inserted elements follow the ones that are equal to them.
+  using Entry = std::pair<int, char>;
+  List<Entry> entries{{1, 'a'}, {2, 'a'}};
+  entries.insert_batch_sorted(
+    std::array<Entry, 3>{Entry{1, 'b'}, Entry{1, 'c'}, Entry{3, 'b'}},
+    [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; });
+  ASSERT_EQ(
+    true,
+    (entries
+     == List<Entry>{{1, 'a'}, {1, 'b'}, {1, 'c'}, {2, 'a'}, {3, 'b'}}));
+
+  List<std::string> descending{"d", "b"};
+  descending.insert_batch_sorted(
+    List<std::string>{"e", "c", "a"}, std::greater<>{});
+  ASSERT_EQ((List<std::string>{"e", "d", "c", "b", "a"}), descending);
+
+  List<int> empty{};
+  empty.insert_batch_sorted(std::vector<int>{1, 2});
+  empty.insert_batch_sorted(std::vector<int>{});
+  ASSERT_EQ((List<int>{1, 2}), empty);
+
+  // Batches take their nodes from the slabs of the list instead of a slab
+  // of their own each.
+  using SlabList = List<int, ListConfig{.usesSlabs = true}>;
+  SlabList slabList{};
+
+  for (int i{0}; i < 4'000; ++i) {
+    slabList.insert_batch_sorted(std::array{i});
+  }
+
+  ASSERT_EQ(4'000, slabList.size());
+  ASSERT_EQ(3'999, slabList.back());
+  ASSERT_EQ(true, slabList.layout().gaps < 10);
+
+  // The elements that weren't merged yet are freed if comparing throws.
+  try {
+    slabList.insert_batch_sorted(
+      std::vector<int>{5'000, 1, 5'001}, [](int lhs, int rhs) {
+        if (lhs == 1) { throw std::runtime_error{"failed"}; }
+
+        return lhs < rhs;
+      });
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    ASSERT_EQ(4'001, slabList.size());
+    ASSERT_EQ(5'000, slabList.back());
+  }
+}
+
+TEST(shouldApplyABatchOfInsertionsAndErasures)
+{
+  List<int>  list{1, 2, 3, 4, 5, 6};
+  const auto at{[&list](int index) {
+    return List<int>::const_iterator{std::next(list.begin(), index)};
+  }};
+
+  const std::vector<std::pair<List<int>::const_iterator, int>> insertions{
+    {at(2), 30}, {list.end(), 70}, {at(2), 31}, {at(4), 50}};
+  const std::vector<List<int>::const_iterator> erasures{at(2), at(0)};
+
+  list.apply_batch(insertions, erasures);
+  ASSERT_EQ((List<int>{2, 30, 31, 4, 50, 5, 6, 70}), list);
+  ASSERT_EQ(8, list.size());
+
+  // Mutable iterators can be used for the positions as well.
+  const std::vector<std::pair<List<int>::iterator, int>> mutableInsertions{
+    {list.begin(), 1}, {std::next(list.begin()), 29}};
+  const std::vector<List<int>::iterator> mutableErasures{
+    std::prev(list.end())};
+  list.apply_batch(mutableInsertions, mutableErasures);
+  ASSERT_EQ((List<int>{1, 2, 29, 30, 31, 4, 50, 5, 6}), list);
+
+  List<std::string> strings{"b"};
+  strings.apply_batch(
+    std::array{
+      std::pair{strings.cbegin(), "a"s}, std::pair{strings.cend(), "c"s}},
+    std::vector<List<std::string>::const_iterator>{});
+  ASSERT_EQ((List<std::string>{"a", "b", "c"}), strings);
+
+  // Nothing changes if a value can't be copied.
+  const auto failing{
+    std::views::iota(0, 3) | std::views::transform([&strings](int i) {
+      if (i == 2) { throw std::runtime_error{"failed"}; }
+
+      return std::pair{strings.cbegin(), std::to_string(i)};
+    })};
+
+  try {
+    strings.apply_batch(failing, std::array{strings.cbegin()});
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    ASSERT_EQ((List<std::string>{"a", "b", "c"}), strings);
+  }
+}
+
+TEST(shouldBeAbleToPrintAList)
+{
+  const List<int>    l{makeTestList()};
+  std::ostringstream oss{};
+  oss << l;
+  const std::string actual{oss.str()};
+  ASSERT_EQ("List[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]"s, actual);
+
+  const List<int>    empty{};
+  std::ostringstream oss2{};
+  oss2 << empty;
+  ASSERT_EQ("List[]", oss2.str());
+}
+
+TEST(shouldBeAbleToCompareListsForEquality)
 {
   const List<int> l1{makeTestList()};
   const List<int> l2{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
   const List<int> l3{1, 2, 3};
   const List<int> l4{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
 
-  ASSERT_EQ(l1, l1);
-  ASSERT_EQ(l1, l2);
-  ASSERT_NE(l1, l3);
-  ASSERT_NE(l1, l4);
+  ASSERT_EQ(l1, l1);
+  ASSERT_EQ(l1, l2);
+  ASSERT_NE(l1, l3);
+  ASSERT_NE(l1, l4);
+
+  ASSERT_EQ(l2, l1);
+  ASSERT_EQ(l2, l2);
+  ASSERT_NE(l2, l3);
+  ASSERT_NE(l2, l4);
+
+  ASSERT_NE(l3, l1);
+  ASSERT_NE(l3, l2);
+  ASSERT_EQ(l3, l3);
+  ASSERT_NE(l3, l4);
+
+  ASSERT_NE(l4, l1);
+  ASSERT_NE(l4, l2);
+  ASSERT_NE(l4, l3);
+  ASSERT_EQ(l4, l4);
+}
+
+TEST(shouldBeAbleToCompareListsLexicographically)
+{
+  // a shorter list should come before a larger one
+  {
+    List<int> l1{1, 2, 3};
+    List<int> l2{1, 2, 3, 4};
+    ASSERT_EQ(true, l1 < l2);
+  }
+
+  // less than test
+  {
+    List<int> l1{1, 2, 3, 3};
+    List<int> l2{1, 2, 3, 4};
+    ASSERT_EQ(true, l1 < l2);
+  }
+
+  // a longer list should be greater than a shorter list
+  {
+    List<int> l1{makeTestList()};
+    List<int> l2{0, 1, 2, 3, 4};
+    ASSERT_EQ(true, l1 > l2);
+  }
+
+  // greater than test
+  {
+    List<int> l1{1, 2, 5};
+    List<int> l2{1, 2, 4};
+    ASSERT_EQ(true, l1 > l2);
+  }
+
+  // <= with shorter list
+  {
+    List<int> l1{0, 1, 2, 3, 4};
+    List<int> l2{makeTestList()};
+    ASSERT_EQ(true, l1 <= l2);
+  }
+
+  // <= with lesser list
+  {
+    List<int> l1{1, 2, 3};
+    List<int> l2{1, 2, 4};
+    ASSERT_EQ(true, l1 <= l2);
+  }
+
+  // <= with equal list
+  {
+    List<int> l1{makeTestList()}, l2{l1};
+    ASSERT_EQ(true, l1 <= l2);
+  }
+
+  // >= with longer list
+  {
+    List<int> l1{1, 2};
+    List<int> l2{1, 2, 3};
+    ASSERT_EQ(true, l2 >= l1);
+  }
+
+  // >= with greater lest
+  {
+    List<int> l1{1, 2, 4};
+    List<int> l2{1, 2, 3};
+    ASSERT_EQ(true, l1 >= l2);
+  }
+
+  // >= with equal list
+  {
+    List<int> l1{1, 2, 3, 4};
+    List<int> l2{1, 2, 3, 4};
+    ASSERT_EQ(true, l1 >= l2);
+  }
+}
+
+template<typename Ty>
+std::string streamText(const List<Ty>& list)
+{
+  std::ostringstream oss{};
+  oss << list;
+  return oss.str();
+}
+
+template<typename Ty>
+std::string appendedText(const List<Ty>& list)
+{
+  std::string buffer{};
+  appendTo(buffer, list);
+  return buffer;
+}
+
+TEST(shouldAppendTheSameTextAsTheStreamOperator)
+{
+  const List<int>         empty{};
+  const List<int>         ints{makeTestList()};
+  const List<long long>   extremes{LLONG_MIN, -1, 0, LLONG_MAX};
+  const List<unsigned>    unsignedInts{0U, 42U, UINT_MAX};
+  const List<double> doubles{3.14159265, 1e20, -0.5, 100000000.0, 0.1, -0.0};
+  const List<float>       floats{1.5F, 2.25e-7F, 123456.0F};
+  const List<std::string> strings{"abc", "", "de f"};
+  const List<char>        chars{'a', 'b', 'c'};
+
+  ASSERT_EQ(streamText(empty), appendedText(empty));
+  ASSERT_EQ(streamText(ints), appendedText(ints));
+  ASSERT_EQ(streamText(extremes), appendedText(extremes));
+  ASSERT_EQ(streamText(unsignedInts), appendedText(unsignedInts));
+  ASSERT_EQ(streamText(doubles), appendedText(doubles));
+  ASSERT_EQ(streamText(floats), appendedText(floats));
+  ASSERT_EQ(streamText(strings), appendedText(strings));
+  ASSERT_EQ(streamText(chars), appendedText(chars));
+  ASSERT_EQ(
+    "List[3.14159, 1e+20, -0.5, 1e+08, 0.1, -0]"s, appendedText(doubles));
+}
+
+TEST(shouldAppendToAReusedBuffer)
+{
+  std::string buffer{"first: "};
+  appendTo(buffer, List<int>{1, 2});
+  buffer += "; second: ";
+  appendTo(buffer, List<int>{});
+  ASSERT_EQ("first: List[1, 2]; second: List[]"s, buffer);
+
+  buffer.clear();
+  appendTo(buffer, List<int>{3});
+  ASSERT_EQ("List[3]"s, buffer);
+}
+
+#ifdef __cpp_lib_format
+TEST(shouldBeAbleToFormatAList)
+{
+  ASSERT_EQ("List[]"s, std::format("{}", List<int>{}));
+  ASSERT_EQ(
+    "List[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]"s,
+    std::format("{}", makeTestList()));
+  ASSERT_EQ("List[1.5, 0.1]"s, std::format("{}", List<double>{1.5, 0.1}));
+  ASSERT_EQ(
+    "List[abc, de]"s, std::format("{}", List<std::string>{"abc", "de"}));
+
+  // Without a format spec numbers look like they do when streamed.
+  const List<double> doubles{123456789.0, 3.14159265, 1e20, -0.0};
+  ASSERT_EQ(streamText(doubles), std::format("{}", doubles));
+  ASSERT_EQ(
+    "List[1.23457e+08, 3.14159, 1e+20, -0]"s, std::format("{}", doubles));
+}
+
+TEST(shouldPassTheFormatSpecToTheElements)
+{
+  ASSERT_EQ(
+    "List[1.00, 2.50]"s, std::format("{:.2f}", List<double>{1.0, 2.5}));
+  ASSERT_EQ("List[  1,  22]"s, std::format("{:>3}", List<int>{1, 22}));
+  ASSERT_EQ("List[0x1f, 0xa]"s, std::format("{:#x}", List<int>{31, 10}));
+}
+#endif
+
+TEST(shouldBehaveLikeAListWhenModifyingAPersistentList)
+{
+  PersistentList<int> persistent{};
+  List<int>           model{};
+
+  for (int i{0}; i < 300; ++i) {
+    persistent.push_back(i);
+    model.push_back(i);
+    persistent.push_front(-i);
+    model.push_front(-i);
+  }
+
+  for (int i{0}; i < 200; ++i) {
+    const std::size_t index{static_cast<std::size_t>(i * 37) % model.size()};
+    const auto        it{persistent.insert(
+      std::next(persistent.begin(), static_cast<std::ptrdiff_t>(index)),
+      1000 + i)};
+    model.insert(std::next(model.begin(), index), 1000 + i);
+    ASSERT_EQ(1000 + i, *it);
+  }
+
+  for (int i{0}; i < 250; ++i) {
+    const std::size_t index{static_cast<std::size_t>(i * 53) % model.size()};
+    const auto        it{persistent.erase(
+      std::next(persistent.begin(), static_cast<std::ptrdiff_t>(index)))};
+    const auto modelIt{model.erase(std::next(model.begin(), index))};
+
+    if (modelIt == model.end()) { ASSERT_EQ(persistent.end(), it); }
+    else {
+      ASSERT_EQ(*modelIt, *it);
+    }
+  }
+
+  persistent.pop_back();
+  model.pop_back();
+  persistent.pop_front();
+  model.pop_front();
+
+  ASSERT_EQ(model.size(), persistent.size());
+  ASSERT_EQ(model, persistent.toList());
+  ASSERT_EQ(
+    true,
+    std::equal(
+      persistent.rbegin(), persistent.rend(), model.rbegin(), model.rend()));
+  ASSERT_EQ(model[17], persistent[17]);
+  ASSERT_EQ(model.front(), persistent.front());
+  ASSERT_EQ(model.back(), persistent.back());
+}
+
+TEST(shouldCopyAPersistentListWithoutAllocatingNodes)
+{
+  PersistentList<int> original{};
+
+  for (int i{0}; i < 1000; ++i) { original.push_back(i); }
+
+  const std::size_t allocationsBeforeCopy{recordedAllocationCount()};
+  PersistentList<int> copy{original};
+  ASSERT_EQ(allocationsBeforeCopy, recordedAllocationCount());
+  ASSERT_EQ(original, copy);
+
+  copy.push_back(1000);
+  copy.erase(std::next(copy.begin(), 500));
+  ASSERT_EQ(
+    true,
+    recordedAllocationCount() - allocationsBeforeCopy
+      <= 2 * (2 * PersistentList<int>::segmentCapacity + 1));
+  ASSERT_EQ(1000, original.size());
+  ASSERT_EQ(1000, copy.size());
+  ASSERT_EQ(999, original.back());
+  ASSERT_EQ(1000, copy.back());
+  ASSERT_EQ(500, original[500]);
+  ASSERT_EQ(501, copy[500]);
+}
+
+TEST(shouldNotAffectOtherVersionsOfAPersistentList)
+{
+  const PersistentList<int> v1{1, 2, 3, 4, 5};
+  PersistentList<int>       v2{v1};
+  v2.erase(std::next(v2.begin(), 2));
+  v2.insert(v2.begin(), 0);
+  PersistentList<int> v3{v2};
+  v3.pop_front();
+  v3.push_back(6);
+  PersistentList<int> v4{v3};
+  v4.clear();
+
+  ASSERT_EQ("PersistentList[1, 2, 3, 4, 5]"s, toString(v1));
+  ASSERT_EQ("PersistentList[0, 1, 2, 4, 5]"s, toString(v2));
+  ASSERT_EQ("PersistentList[1, 2, 4, 5, 6]"s, toString(v3));
+  ASSERT_EQ("PersistentList[]"s, toString(v4));
+  ASSERT_EQ(true, v4.empty());
+  ASSERT_EQ(v4.begin(), v4.end());
+  ASSERT_NE(v1, v3);
+  ASSERT_EQ((PersistentList<int>{List<int>{1, 2, 4, 5, 6}}), v3);
+}
+
+TEST(shouldThrowWhenAccessingAnEmptyPersistentList)
+{
+  const PersistentList<int> emptyList{};
+
+  try {
+    emptyList.front();
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::out_of_range& ex) {
+    ASSERT_EQ("PersistentList::front called on empty list."s, ex.what());
+  }
+
+  try {
+    emptyList[0];
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::out_of_range& ex) {
+    ASSERT_EQ(
+      "PersistentList::operator[]: index out of bounds: 0 is >= size() (0)!"s,
+      ex.what());
+  }
+}
+
+TEST(shouldKeepAPersistentListIntactIfCopyingAnElementThrows)
+{
+  PersistentList<CopyCounted> list{};
+
+  // Fills the only segment, so that both ends need a new one.
+  for (int i{0}; i < 64; ++i) { list.push_front(CopyCounted{i}); }
+
+  CopyCounted::copiesLeft = 0;
+
+  try {
+    list.push_front(CopyCounted{64});
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    CopyCounted::copiesLeft = 0;
+  }
+
+  try {
+    list.push_back(CopyCounted{-1});
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error&) {
+    CopyCounted::copiesLeft = INT_MAX;
+  }
+
+  ASSERT_EQ(64, list.size());
+  ASSERT_EQ(63, list.front().value);
+  ASSERT_EQ(0, list.back().value);
+  ASSERT_EQ(64, std::distance(list.begin(), list.end()));
+}
+
+TEST(shouldBeAbleToModifyAnRcuList)
+{
+  RcuList<int> l{};
+
+  for (int i{0}; i < 5; ++i) { l.push_back(i); }
+
+  l.push_front(-1);
+  l.insert(std::next(l.begin(), 2), 99);
+  ASSERT_EQ("RcuList[-1, 0, 99, 1, 2, 3, 4]"s, toString(l));
+  ASSERT_EQ(7, l.size());
+
+  const auto it{l.erase(std::next(l.begin(), 2))};
+  ASSERT_EQ(1, *it);
+  l.pop_back();
+  l.pop_front();
+  ASSERT_EQ("RcuList[0, 1, 2, 3]"s, toString(l));
+  ASSERT_EQ(0, l.front());
+  ASSERT_EQ(3, l.back());
+
+  ASSERT_EQ(2, l.remove_if([](int i) { return i % 2 == 1; }));
+  ASSERT_EQ("RcuList[0, 2]"s, toString(l));
+
+  l.clear();
+  ASSERT_EQ(true, l.empty());
+  ASSERT_EQ("RcuList[]"s, toString(l));
+  l.synchronize();
+  ASSERT_EQ(0, l.retired_size());
+}
+
+TEST(shouldDeferFreeingErasedRcuListNodesUntilReadersAreDone)
+{
+  RcuList<int>         l{};
+  RcuList<int>::Reader reader{l};
+
+  for (int i{0}; i < 3; ++i) { l.push_back(i); }
+
+  {
+    auto guard{reader.lock()};
+    auto it{std::next(guard.begin())};
+    ASSERT_EQ(1, *it);
+
+    l.erase(std::next(l.begin()));
+    l.reclaim();
+    ASSERT_EQ(1, l.retired_size());
+
+    // A reader positioned on an unlinked node can continue traversing.
+    ASSERT_EQ(1, *it);
+    ++it;
+    ASSERT_EQ(2, *it);
+    ++it;
+    ASSERT_EQ(guard.end(), it);
+  }
+
+  l.reclaim();
+  ASSERT_EQ(0, l.retired_size());
+
+  {
+    auto      guard{reader.lock()};
+    const int expected[]{0, 2};
+    ASSERT_EQ(
+      true,
+      std::equal(
+        guard.begin(), guard.end(), std::begin(expected), std::end(expected)));
+  }
+}
+
+EXCLUSIVE_TEST(shouldLetReadersTraverseAnRcuListWhileItIsBeingModified)
+{
+  // The writer keeps the elements even and strictly increasing; readers
+  // verify that they never observe anything else.
+  RcuList<std::int64_t>    l{};
+  std::atomic<bool>        done{false};
+  std::atomic<std::size_t> violations{0};
+  std::atomic<std::size_t> traversals{0};
+  std::int64_t             nextValue{0};
+
+  for (int i{0}; i < 200; ++i) {
+    l.push_back(nextValue);
+    nextValue += 1000;
+  }
+
+  std::vector<std::thread> readers{};
+
+  for (int i{0}; i < 4; ++i) {
+    readers.emplace_back([&l, &done, &violations, &traversals] {
+      RcuList<std::int64_t>::Reader reader{l};
+
+      while (!done.load()) {
+        auto         guard{reader.lock()};
+        std::int64_t previous{-1};
+
+        for (std::int64_t element : guard) {
+          if (element % 2 != 0 || element <= previous) { ++violations; }
+
+          previous = element;
+        }
+
+        ++traversals;
+      }
+    });
+  }
+
+  for (int operation{0}; operation < 20000 || traversals.load() < 100;
+       ++operation) {
+    switch (operation % 4) {
+    case 0:
+      l.pop_front();
+      l.push_back(nextValue);
+      nextValue += 1000;
+      break;
+    case 1: {
+      const auto pos{std::next(l.begin(), operation % 150 + 1)};
+      const auto prev{std::next(l.begin(), operation % 150)};
+
+      if (*pos - *prev >= 4) { l.insert(pos, (*prev + *pos) / 2 / 2 * 2); }
+
+      break;
+    }
+    case 2: l.erase(std::next(l.begin(), operation % 100 + 1)); break;
+    default: l.push_back(nextValue); nextValue += 1000;
+    }
+  }
+
+  done.store(true);
+
+  for (std::thread& reader : readers) { reader.join(); }
+
+  l.synchronize();
+  ASSERT_EQ(0, violations.load());
+  ASSERT_EQ(0, l.retired_size());
+  ASSERT_EQ(true, traversals.load() >= 100);
+}
+
+TEST(shouldFindElementsOfALinkedHashListByValue)
+{
+  LinkedHashList<std::string> list{"c", "a", "b"};
+
+  ASSERT_EQ(true, list.contains("a"));
+  ASSERT_EQ(false, list.contains("d"));
+  ASSERT_EQ("a", *list.find("a"));
+  ASSERT_EQ(list.end(), list.find("d"));
+  ASSERT_EQ(std::next(list.begin()), list.find("a"));
+
+  // Inserting an element that is already contained doesn't change the set.
+  ASSERT_EQ(list.find("c"), list.insert(list.end(), "c"));
+  ASSERT_EQ(3, list.size());
+
+  list.push_front("d");
+  ASSERT_EQ("LinkedHashList[d, c, a, b]", toString(list));
+  ASSERT_EQ(1, list.erase("a"));
+  ASSERT_EQ(0, list.erase("a"));
+  ASSERT_EQ("LinkedHashList[d, c, b]", toString(list));
+  ASSERT_EQ(false, list.contains("a"));
+
+  list.sort();
+  ASSERT_EQ("LinkedHashList[b, c, d]", toString(list));
+  ASSERT_EQ("d", *list.find("d"));
+  ASSERT_EQ("d", list.back());
+
+  list.pop_front();
+  list.pop_back();
+  ASSERT_EQ((LinkedHashList<std::string>{"c"}), list);
+
+  list.clear();
+  ASSERT_EQ(true, list.empty());
+  ASSERT_EQ(false, list.contains("c"));
+}
+
+TEST(shouldKeepTheIndexOfALinkedHashListInSync)
+{
+  LinkedHashList<int> list{};
+
+  for (int i{0}; i < 1000; ++i) { list.push_back(i); }
+
+  ASSERT_EQ(
+    500, list.remove_if([](int element) { return element % 2 == 0; }));
+
+  for (int i{0}; i < 1000; i += 4) { list.push_back(i); }
+
+  for (int i{0}; i < 1000; ++i) {
+    ASSERT_EQ(i % 2 != 0 || i % 4 == 0, list.contains(i));
+  }
+
+  ASSERT_EQ(750, list.size());
+  ASSERT_EQ(1, list.front());
+  ASSERT_EQ(996, list.back());
+
+  LinkedHashList<int> copy{list};
+
+  while (!list.empty()) { list.erase(list.front()); }
+
+  ASSERT_EQ(false, list.contains(1));
+  ASSERT_EQ(true, copy.contains(1));
+  ASSERT_EQ(750, copy.size());
+}
+
+TEST(shouldCountDuplicatesInALinkedHashMultiset)
+{
+  LinkedHashList<int, std::hash<int>, std::equal_to<int>, true> list{
+    1, 2, 1, 3, 1};
+
+  ASSERT_EQ(3, list.count(1));
+  ASSERT_EQ(1, list.count(2));
+  ASSERT_EQ(0, list.count(4));
+  ASSERT_EQ(1, *list.find(1));
+  ASSERT_EQ(3, list.erase(1));
+  ASSERT_EQ("LinkedHashList[2, 3]", toString(list));
+}
+
+TEST(shouldEraseTheElementThatTheErasedValueRefersTo)
+{
+  const std::string           longString{"a long string that is allocated"};
+  LinkedHashList<std::string> set{longString, "b"};
+
+  ASSERT_EQ(1, set.erase(set.front()));
+  ASSERT_EQ("LinkedHashList[b]", toString(set));
+  ASSERT_EQ(1, set.erase(set.front()));
+  ASSERT_EQ(true, set.empty());
+
+  LinkedHashList<
+    std::string,
+    std::hash<std::string>,
+    std::equal_to<std::string>,
+    true>
+    multiset{longString, "b", longString};
+
+  ASSERT_EQ(2, multiset.erase(multiset.front()));
+  ASSERT_EQ("LinkedHashList[b]", toString(multiset));
+}
+
+TEST(shouldEraseTheElementsThatTheErasedValueOfASortedListRefersTo)
+{
+  const std::string       longString{"a long string that is allocated"};
+  SortedList<std::string> list{longString, "b", longString};
+
+  ASSERT_EQ(2, list.erase(list.front()));
+  ASSERT_EQ("SortedList[b]", toString(list));
+  ASSERT_EQ(1, list.erase(list.back()));
+  ASSERT_EQ(true, list.empty());
+}
+
+TEST(shouldKeepASortedListSorted)
+{
+  SortedList<int> list{5, 1, 4, 1, 3};
+
+  ASSERT_EQ("SortedList[1, 1, 3, 4, 5]", toString(list));
+
+  list.insert(2);
+  list.insert(6);
+  list.insert(0);
+  ASSERT_EQ("SortedList[0, 1, 1, 2, 3, 4, 5, 6]", toString(list));
+  ASSERT_EQ(0, list.front());
+  ASSERT_EQ(6, list.back());
+
+  ASSERT_EQ(2, list.count(1));
+  ASSERT_EQ(true, list.contains(4));
+  ASSERT_EQ(false, list.contains(7));
+  ASSERT_EQ(list.end(), list.find(7));
+  ASSERT_EQ(3, *list.lower_bound(3));
+  ASSERT_EQ(4, *list.upper_bound(3));
+  ASSERT_EQ(list.end(), list.upper_bound(6));
+
+  const auto [first, last]{list.equal_range(1)};
+  ASSERT_EQ(std::next(list.begin()), first);
+  ASSERT_EQ(std::next(list.begin(), 3), last);
+
+  ASSERT_EQ(2, list.erase(1));
+  ASSERT_EQ(4, *list.erase(list.find(3)));
+  list.pop_front();
+  list.pop_back();
+  ASSERT_EQ("SortedList[2, 4, 5]", toString(list));
+  ASSERT_EQ(
+    "SortedList[5, 4, 2]",
+    toString(SortedList<int, std::greater<int>>{2, 4, 5}));
+}
+
+TEST(shouldKeepEqualElementsOfASortedListInInsertionOrder)
+{
+  using Pair = std::pair<int, int>;
+
+  const auto byFirst{
+    [](const Pair& lhs, const Pair& rhs) { return lhs.first < rhs.first; }};
+  SortedList<Pair, decltype(byFirst)> list{byFirst};
+
+  for (int i{0}; i < 100; ++i) { list.insert(Pair{i % 3, i}); }
+
+  list.insert_sorted(std::vector<Pair>{{0, 100}, {1, 101}, {2, 102}});
+
+  int previousFirst{0};
+  int previousSecond{-1};
+
+  for (const auto& [first, second] : list) {
+    if (first != previousFirst) { previousSecond = -1; }
+
+    ASSERT_EQ(true, second > previousSecond);
+    previousFirst  = first;
+    previousSecond = second;
+  }
+
+  ASSERT_EQ(35, list.count(Pair{0, 0}));
+  ASSERT_EQ(100, std::prev(list.upper_bound(Pair{0, 0}))->second);
+}
+
+TEST(shouldMergeRangesIntoASortedList)
+{
+  SortedList<int> list{};
+
+  for (int i{0}; i < 2000; i += 2) { list.insert(i); }
+
+  std::vector<int> odd{};
+
+  for (int i{-1}; i < 2001; i += 2) { odd.push_back(i); }
+
+  list.insert_sorted(odd);
+  ASSERT_EQ(2001, list.size());
+  ASSERT_EQ(true, std::is_sorted(list.begin(), list.end()));
+  ASSERT_EQ(-1, list.front());
+  ASSERT_EQ(1999, list.back());
+
+  // Out of order elements end up in the right place, too.
+  list.insert_sorted(std::vector<int>{3000, 1000, -2000, 5});
+  ASSERT_EQ(2005, list.size());
+  ASSERT_EQ(true, std::is_sorted(list.begin(), list.end()));
+  ASSERT_EQ(true, std::is_sorted(list.rbegin(), list.rend(), std::greater{}));
+
+  for (int i{0}; i < 2000; ++i) { ASSERT_EQ(i, *list.lower_bound(i)); }
+
+  const SortedList<int> copy{list};
+  ASSERT_EQ(list, copy);
+
+  ASSERT_EQ(
+    1002, list.remove_if([](int element) { return element % 2 != 0; }));
+  ASSERT_EQ(true, list.contains(1000));
+  ASSERT_EQ(2, list.count(1000));
+  ASSERT_EQ(false, list.contains(1001));
+
+  list.clear();
+  ASSERT_EQ(true, list.empty());
+  ASSERT_EQ(list.end(), list.lower_bound(0));
+}
+
+TEST(shouldEvictLeastRecentlyUsedEntries)
+{
+  LruCache<int, std::string> cache{3};
+
+  ASSERT_EQ(true, cache.put(1, "one"));
+  ASSERT_EQ(true, cache.put(2, "two"));
+  ASSERT_EQ(true, cache.put(3, "three"));
+  ASSERT_EQ("three", *cache.find(3));
+  ASSERT_EQ("one", *cache.find(1));
+  ASSERT_EQ(nullptr, cache.find(4));
+  ASSERT_EQ("LruCache[1: one, 3: three, 2: two]", toString(cache));
+
+  ASSERT_EQ(true, cache.put(4, "four"));
+  ASSERT_EQ("LruCache[4: four, 1: one, 3: three]", toString(cache));
+  ASSERT_EQ(false, cache.contains(2));
+  ASSERT_EQ(3, cache.size());
+
+  ASSERT_EQ(true, cache.put(3, "drei"));
+  ASSERT_EQ("LruCache[3: drei, 4: four, 1: one]", toString(cache));
+
+  ASSERT_EQ(2, cache.hits());
+  ASSERT_EQ(1, cache.misses());
+  ASSERT_EQ(1, cache.evictions());
+
+  ASSERT_EQ(true, cache.erase(4));
+  ASSERT_EQ(false, cache.erase(4));
+  ASSERT_EQ("LruCache[3: drei, 1: one]", toString(cache));
+
+  cache.clear();
+  ASSERT_EQ("LruCache[]", toString(cache));
+  ASSERT_EQ(0, cache.total_cost());
+}
+
+TEST(shouldLimitLruCacheByCost)
+{
+  const auto byteCost{[](int, const std::string& value) {
+    return value.size();
+  }};
+  LruCache<int, std::string, decltype(byteCost)> cache{10, byteCost};
+
+  cache.put(1, "aaaa");
+  cache.put(2, "bbbb");
+  ASSERT_EQ(8, cache.total_cost());
+
+  cache.put(3, "ccc");
+  ASSERT_EQ("LruCache[3: ccc, 2: bbbb]", toString(cache));
+  ASSERT_EQ(7, cache.total_cost());
+
+  cache.put(2, "b");
+  ASSERT_EQ(4, cache.total_cost());
+
+  ASSERT_EQ(false, cache.put(4, "this is too expensive"));
+  ASSERT_EQ(false, cache.put(3, "this is too expensive"));
+  ASSERT_EQ("LruCache[2: b]", toString(cache));
+  ASSERT_EQ(1, cache.total_cost());
+  ASSERT_EQ(1, cache.evictions());
+}
 
-  ASSERT_EQ(l2, l1);
-  ASSERT_EQ(l2, l2);
-  ASSERT_NE(l2, l3);
-  ASSERT_NE(l2, l4);
+Task produce(Channel<int>& channel, int count, int& produced)
+{
+  for (int i{0}; i < count; ++i) {
+    co_await channel.push_back(i);
+    ++produced;
+  }
 
-  ASSERT_NE(l3, l1);
-  ASSERT_NE(l3, l2);
-  ASSERT_EQ(l3, l3);
-  ASSERT_NE(l3, l4);
+  channel.close();
+}
 
-  ASSERT_NE(l4, l1);
-  ASSERT_NE(l4, l2);
-  ASSERT_NE(l4, l3);
-  ASSERT_EQ(l4, l4);
+Task consume(Channel<int>& channel, List<int>& consumed)
+{
+  while (const std::optional<int> element{co_await channel.pop_front()}) {
+    consumed.push_back(*element);
+  }
 }
 
-TEST(shouldBeAbleToCompareListsLexicographically)
+Task consumeMany(
+  Channel<int>&            channel,
+  std::size_t              maxCount,
+  std::vector<List<int>>& batches)
 {
-  // a shorter list should come before a larger one
-  {
-    List<int> l1{1, 2, 3};
-    List<int> l2{1, 2, 3, 4};
-    ASSERT_EQ(true, l1 < l2);
+  while (true) {
+    List<int> batch{co_await channel.pop_many(maxCount)};
+
+    if (batch.empty()) { co_return; }
+
+    batches.push_back(batch);
   }
+}
 
-  // less than test
-  {
-    List<int> l1{1, 2, 3, 3};
-    List<int> l2{1, 2, 3, 4};
-    ASSERT_EQ(true, l1 < l2);
+TEST(shouldPassElementsThroughAChannel)
+{
+  SingleThreadedExecutor executor{};
+  Channel<int>           channel{executor, 2};
+  int                    produced{0};
+  List<int>              consumed{};
+
+  spawn(executor, consume(channel, consumed));
+  spawn(executor, produce(channel, 10, produced));
+  executor.run();
+
+  ASSERT_EQ(10, produced);
+  ASSERT_EQ((List<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), consumed);
+  ASSERT_EQ(0, channel.size());
+}
+
+TEST(shouldSuspendProducersOfAFullChannel)
+{
+  SingleThreadedExecutor executor{};
+  Channel<int>           channel{executor, 3};
+  int                    produced{0};
+
+  spawn(executor, produce(channel, 5, produced));
+  executor.run();
+
+  // The producer is suspended, the thread is free to do other work.
+  ASSERT_EQ(3, produced);
+  ASSERT_EQ(3, channel.size());
+
+  List<int> consumed{};
+  spawn(executor, consume(channel, consumed));
+  executor.run();
+
+  ASSERT_EQ(5, produced);
+  ASSERT_EQ((List<int>{0, 1, 2, 3, 4}), consumed);
+}
+
+TEST(shouldPopManyElementsFromAChannelAtOnce)
+{
+  SingleThreadedExecutor executor{};
+  Channel<int>           channel{executor, 16};
+  int                    produced{0};
+  std::vector<List<int>> batches{};
+
+  spawn(executor, produce(channel, 10, produced));
+  executor.run();
+  spawn(executor, consumeMany(channel, 4, batches));
+  executor.run();
+
+  ASSERT_EQ(3, batches.size());
+  ASSERT_EQ((List<int>{0, 1, 2, 3}), batches[0]);
+  ASSERT_EQ((List<int>{4, 5, 6, 7}), batches[1]);
+  ASSERT_EQ((List<int>{8, 9}), batches[2]);
+}
+
+TEST(shouldSplitBatchesOffAChannelAtTheRunsThatWerePushed)
+{
+  SingleThreadedExecutor executor{};
+  Channel<int>           channel{executor, 16};
+  std::vector<List<int>> batches{};
+
+  const auto pushAll{[](Channel<int>& ch, int first, int last) -> Task {
+    for (int i{first}; i < last; ++i) { co_await ch.push_back(i); }
+  }};
+  const auto popAll{[](
+                      Channel<int>&            ch,
+                      std::vector<std::size_t> maxCounts,
+                      std::vector<List<int>>&  out) -> Task {
+    for (std::size_t maxCount : maxCounts) {
+      out.push_back(co_await ch.pop_many(maxCount));
+    }
+  }};
+
+  spawn(executor, pushAll(channel, 0, 5));
+  spawn(executor, popAll(channel, {2}, batches));
+  executor.run();
+
+  // Elements pushed from now on are kept in runs of 2.
+  spawn(executor, pushAll(channel, 5, 10));
+  spawn(executor, popAll(channel, {1, 2, 3, 10}, batches));
+  executor.run();
+
+  ASSERT_EQ(5, batches.size());
+  ASSERT_EQ((List<int>{0, 1}), batches[0]);
+  ASSERT_EQ((List<int>{2}), batches[1]);
+  ASSERT_EQ((List<int>{3, 4}), batches[2]);
+  ASSERT_EQ((List<int>{5, 6, 7}), batches[3]);
+  ASSERT_EQ((List<int>{8, 9}), batches[4]);
+  ASSERT_EQ(0, channel.size());
+}
+
+TEST(shouldRejectPushesToAClosedChannel)
+{
+  SingleThreadedExecutor executor{};
+  Channel<int>           channel{executor, 1};
+  List<bool>             results{};
+
+  const auto pushAll{[](Channel<int>& ch, List<bool>& res) -> Task {
+    for (int i{0}; i < 3; ++i) { res.push_back(co_await ch.push_back(i)); }
+  }};
+
+  spawn(executor, pushAll(channel, results));
+  executor.run();
+  ASSERT_EQ(1, results.size());
+
+  channel.close();
+  executor.run();
+  ASSERT_EQ((List<bool>{true, false, false}), results);
+
+  List<int> consumed{};
+  spawn(executor, consume(channel, consumed));
+  executor.run();
+  ASSERT_EQ((List<int>{0}), consumed);
+}
+
+EXCLUSIVE_TEST(shouldPassElementsThroughAChannelOnAThreadPool)
+{
+  constexpr int producerCount{4};
+  constexpr int elementsPerProducer{2000};
+
+  ThreadPoolExecutor     executor{4};
+  Channel<int>           channel{executor, 8};
+  std::atomic<int>       producersLeft{producerCount};
+  std::atomic<long long> sum{0};
+  std::atomic<int>       received{0};
+
+  const auto producer{
+    [](Channel<int>& ch, std::atomic<int>& left, int first) -> Task {
+      for (int i{first}; i < first + elementsPerProducer; ++i) {
+        co_await ch.push_back(i);
+      }
+
+      if (--left == 0) { ch.close(); }
+    }};
+  const auto consumer{[](
+                        Channel<int>&           ch,
+                        std::atomic<long long>& total,
+                        std::atomic<int>&       count) -> Task {
+    while (true) {
+      const List<int> batch{co_await ch.pop_many(3)};
+
+      if (batch.empty()) { co_return; }
+
+      for (int element : batch) {
+        total += element;
+        ++count;
+      }
+    }
+  }};
+
+  for (int i{0}; i < 2; ++i) {
+    spawn(executor, consumer(channel, sum, received));
   }
 
-  // a longer list should be greater than a shorter list
-  {
-    List<int> l1{makeTestList()};
-    List<int> l2{0, 1, 2, 3, 4};
-    ASSERT_EQ(true, l1 > l2);
+  for (int i{0}; i < producerCount; ++i) {
+    spawn(executor, producer(channel, producersLeft, i * elementsPerProducer));
   }
 
-  // greater than test
+  executor.wait();
+
+  const long long n{producerCount * elementsPerProducer};
+  ASSERT_EQ(n, received.load());
+  ASSERT_EQ(n * (n - 1) / 2, sum.load());
+}
+
+#ifdef __linux__
+struct TemporaryFile {
+  TemporaryFile() : path{}
   {
-    List<int> l1{1, 2, 5};
-    List<int> l2{1, 2, 4};
-    ASSERT_EQ(true, l1 > l2);
+    std::string pattern{
+      (std::filesystem::temp_directory_path() / "mapped_list_XXXXXX")
+        .string()};
+    const int fd{::mkstemp(pattern.data())};
+
+    if (fd == -1) { throw std::runtime_error{"Could not create temp file."}; }
+
+    ::close(fd);
+    path = pattern;
   }
 
-  // <= with shorter list
+  TemporaryFile(const TemporaryFile&) = delete;
+
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+  ~TemporaryFile() { std::remove(path.c_str()); }
+
+  std::string path;
+};
+
+TEST(shouldBeAbleToAddElementsToAMappedList)
+{
+  const TemporaryFile file{};
+  MappedList<int>     l{file.path};
+  ASSERT_EQ(true, l.empty());
+
+  for (int i{0}; i < 5; ++i) { l.push_back(i); }
+
+  l.push_front(-1);
+  ASSERT_EQ(6, l.size());
+  ASSERT_EQ(-1, l.front());
+  ASSERT_EQ(4, l.back());
+
+  const int expected[]{-1, 0, 1, 2, 3, 4};
+  ASSERT_EQ(
+    true,
+    std::equal(l.begin(), l.end(), std::begin(expected), std::end(expected)));
+  ASSERT_EQ(
+    true,
+    std::equal(
+      l.rbegin(), l.rend(), std::rbegin(expected), std::rend(expected)));
+  ASSERT_EQ("MappedList[-1, 0, 1, 2, 3, 4]"s, toString(l));
+}
+
+TEST(shouldRestoreAMappedListWhenReopeningTheFile)
+{
+  const TemporaryFile file{};
+
   {
-    List<int> l1{0, 1, 2, 3, 4};
-    List<int> l2{makeTestList()};
-    ASSERT_EQ(true, l1 <= l2);
+    MappedList<int> l{file.path};
+
+    for (int i{0}; i < 10; ++i) { l.push_back(i * i); }
+
+    l.erase(std::next(l.begin(), 3));
+    l.flush();
   }
 
-  // <= with lesser list
+  const MappedList<int> l{file.path};
+  ASSERT_EQ(9, l.size());
+  ASSERT_EQ("MappedList[0, 1, 4, 16, 25, 36, 49, 64, 81]"s, toString(l));
+}
+
+TEST(shouldGrowAMappedListBeyondItsInitialCapacity)
+{
+  const TemporaryFile file{};
+
   {
-    List<int> l1{1, 2, 3};
-    List<int> l2{1, 2, 4};
-    ASSERT_EQ(true, l1 <= l2);
+    MappedList<std::int64_t> l{file.path, 4};
+    ASSERT_EQ(4, l.capacity());
+
+    for (std::int64_t i{0}; i < 1000; ++i) { l.push_back(i); }
+
+    ASSERT_EQ(true, l.capacity() >= 1000);
   }
 
-  // <= with equal list
-  {
-    List<int> l1{makeTestList()}, l2{l1};
-    ASSERT_EQ(true, l1 <= l2);
+  const MappedList<std::int64_t> l{file.path};
+  ASSERT_EQ(1000, l.size());
+
+  std::int64_t expected{0};
+
+  for (std::int64_t element : l) {
+    ASSERT_EQ(expected, element);
+    ++expected;
   }
+}
 
-  // >= with longer list
-  {
-    List<int> l1{1, 2};
-    List<int> l2{1, 2, 3};
-    ASSERT_EQ(true, l2 >= l1);
+TEST(shouldInsertElementsOfAMappedListWhileItGrows)
+{
+  const TemporaryFile file{};
+  MappedList<int>     l{file.path, 1};
+
+  l.push_back(1);
+
+  // Every other insertion remaps the file that the inserted value lives in.
+  for (int i{0}; i < 6; ++i) {
+    l.push_back(l.back() * 2);
+    l.push_front(l.front());
   }
 
-  // >= with greater lest
+  ASSERT_EQ(true, l.capacity() >= 13);
+  ASSERT_EQ(
+    "MappedList[1, 1, 1, 1, 1, 1, 1, 2, 4, 8, 16, 32, 64]"s, toString(l));
+}
+
+TEST(shouldReuseErasedNodesOfAMappedList)
+{
+  const TemporaryFile file{};
+  MappedList<int>     l{file.path, 7};
+
+  for (int i{0}; i < 7; ++i) { l.push_back(i); }
+
+  ASSERT_EQ(7, l.capacity());
+  ASSERT_EQ(3, l.remove_if([](int i) { return i % 2 == 1; }));
+
+  const auto it{l.insert(std::next(l.begin()), 10)};
+  ASSERT_EQ(10, *it);
+  l.push_back(11);
+  l.push_front(12);
+  ASSERT_EQ(7, l.capacity());
+  ASSERT_EQ("MappedList[12, 0, 10, 2, 4, 6, 11]"s, toString(l));
+
+  l.pop_back();
+  l.pop_front();
+  ASSERT_EQ("MappedList[0, 10, 2, 4, 6]"s, toString(l));
+
+  l.clear();
+  ASSERT_EQ(true, l.empty());
+  ASSERT_EQ(l.begin(), l.end());
+}
+
+TEST(shouldBeAbleToSortAMappedList)
+{
+  const TemporaryFile file{};
+  MappedList<int>     l{file.path};
+
+  for (int i : {5, 1, -5, 15, 9, 1, 0, 7}) { l.push_back(i); }
+
+  l.sort();
+  ASSERT_EQ("MappedList[-5, 0, 1, 1, 5, 7, 9, 15]"s, toString(l));
+
+  l.sort(std::greater<int>{});
+  ASSERT_EQ("MappedList[15, 9, 7, 5, 1, 1, 0, -5]"s, toString(l));
+  ASSERT_EQ(-5, *std::prev(l.end()));
+  ASSERT_EQ(15, *std::prev(l.rend()));
+}
+
+TEST(shouldRejectAMappedListFileOfADifferentType)
+{
+  const TemporaryFile file{};
+
   {
-    List<int> l1{1, 2, 4};
-    List<int> l2{1, 2, 3};
-    ASSERT_EQ(true, l1 >= l2);
+    MappedList<std::int32_t> l{file.path};
+    l.push_back(1);
   }
 
-  // >= with equal list
-  {
-    List<int> l1{1, 2, 3, 4};
-    List<int> l2{1, 2, 3, 4};
-    ASSERT_EQ(true, l1 >= l2);
+  try {
+    MappedList<double> l{file.path};
+    ASSERT_EQ(true, false);
+  }
+  catch (const std::runtime_error& ex) {
+    ASSERT_EQ(
+      "MappedList: file was written for a different value_type."s,
+      ex.what());
   }
 }
+#endif
 
-int main(int argc, char* argv[])
+// Matches name against pattern, in which * stands for any sequence of
+// characters and ? for any single character.
+bool matchesGlob(std::string_view pattern, std::string_view name)
+{
+  std::size_t patternPos{0};
+  std::size_t namePos{0};
+  std::size_t starPos{std::string_view::npos};
+  std::size_t starMatchEnd{0};
+
+  while (namePos < name.size()) {
+    if (
+      patternPos < pattern.size()
+      && (pattern[patternPos] == '?' || pattern[patternPos] == name[namePos])) {
+      ++patternPos;
+      ++namePos;
+    }
+    else if (patternPos < pattern.size() && pattern[patternPos] == '*') {
+      starPos      = patternPos++;
+      starMatchEnd = namePos;
+    }
+    else if (starPos != std::string_view::npos) {
+      patternPos = starPos + 1;
+      namePos    = ++starMatchEnd;
+    }
+    else {
+      return false;
+    }
+  }
+
+  while (patternPos < pattern.size() && pattern[patternPos] == '*') {
+    ++patternPos;
+  }
+
+  return patternPos == pattern.size();
+}
+
+struct TestResult {
+  const TestFunctionWithName* test;
+  std::string                 failure;
+  double                      milliseconds;
+  std::size_t                 leakedAllocations;
+
+  bool passed() const { return failure.empty() && leakedAllocations == 0; }
+};
+
+TestResult runTest(const TestFunctionWithName& test)
 {
-  (void)argc;
-  int exitStatus{EXIT_SUCCESS};
+  TestResult result{&test, "", 0.0, 0};
+  TestRun    testRun{};
+
+  if (test.exclusive) {
+    const std::lock_guard<std::mutex> lock{allocationTrackingMutex};
+    exclusiveTestRun = &testRun;
+  }
+
+  currentTestRun = &testRun;
+  const auto start{std::chrono::steady_clock::now()};
 
   try {
-    std::vector<std::string> successfulFunctions{};
+    test.function();
+  }
+  catch (const AssertionViolationException& ex) {
+    result.failure = ex.what();
+  }
+  catch (const std::exception& ex) {
+    result.failure = "Unexpected exception: "s + ex.what() + '\n';
+  }
+  catch (...) {
+    result.failure = "Unexpected exception of unknown type.\n";
+  }
+
+  result.milliseconds = std::chrono::duration<double, std::milli>{
+    std::chrono::steady_clock::now() - start}
+                          .count();
+  currentTestRun = nullptr;
+
+  const std::lock_guard<std::mutex> lock{allocationTrackingMutex};
+
+  if (test.exclusive) { exclusiveTestRun = nullptr; }
+
+  result.leakedAllocations = testRun.liveAllocationCount;
+
+  // The leaks have been reported for this test case; forget them so that
+  // they don't refer to testRun once it's gone.
+  if (result.leakedAllocations != 0) {
+    std::erase_if(liveAllocations, [&testRun](const auto& allocation) {
+      return allocation.second == &testRun;
+    });
+  }
+
+  return result;
+}
 
-    for (const auto& [func, name] : testFunctions) {
-      func();
-      successfulFunctions.push_back(name);
+// Runs the test cases that aren't exclusive on jobCount threads, then the
+// exclusive ones one after the other.
+std::vector<TestResult> runTests(
+  const std::vector<const TestFunctionWithName*>& tests,
+  std::size_t                                     jobCount)
+{
+  std::vector<TestResult>  results(tests.size());
+  std::atomic<std::size_t> nextTest{0};
+
+  const auto runConcurrentTests{[&tests, &results, &nextTest] {
+    for (std::size_t i{nextTest++}; i < tests.size(); i = nextTest++) {
+      if (!tests[i]->exclusive) { results[i] = runTest(*tests[i]); }
     }
+  }};
+
+  std::vector<std::thread> workers{};
+
+  for (std::size_t i{1}; i < jobCount; ++i) {
+    workers.emplace_back(runConcurrentTests);
+  }
+
+  runConcurrentTests();
 
-    std::cout << ">>>>> TEST SUCCESS\n";
+  for (std::thread& worker : workers) { worker.join(); }
+
+  for (std::size_t i{0}; i < tests.size(); ++i) {
+    if (tests[i]->exclusive) { results[i] = runTest(*tests[i]); }
+  }
 
-    std::size_t testCaseNumber{1};
+  return results;
+}
 
-    for (const std::string& functionName : successfulFunctions) {
-      std::cout << "Test case " << testCaseNumber << " \"" << functionName
-                << "\": SUCCESS.\n";
-      ++testCaseNumber;
+std::string escapeXml(std::string_view text)
+{
+  std::string escaped{};
+
+  for (char c : text) {
+    switch (c) {
+    case '<': escaped += "&lt;"; break;
+    case '>': escaped += "&gt;"; break;
+    case '&': escaped += "&amp;"; break;
+    case '"': escaped += "&quot;"; break;
+    default: escaped += c;
     }
+  }
+
+  return escaped;
+}
 
-    std::cout << ">>>> ALL TESTS RAN SUCCESSFULLY\n";
+std::string escapeJson(std::string_view text)
+{
+  std::string escaped{};
+
+  for (char c : text) {
+    switch (c) {
+    case '"': escaped += "\\\""; break;
+    case '\\': escaped += "\\\\"; break;
+    case '\n': escaped += "\\n"; break;
+    case '\t': escaped += "\\t"; break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        constexpr char hexDigits[]{"0123456789abcdef"};
+        escaped += "\\u00";
+        escaped += hexDigits[(c >> 4) & 0xF];
+        escaped += hexDigits[c & 0xF];
+      }
+      else {
+        escaped += c;
+      }
+    }
+  }
+
+  return escaped;
+}
+
+std::string failureMessage(const TestResult& result)
+{
+  if (result.leakedAllocations == 0) { return result.failure; }
+
+  return result.failure + std::to_string(result.leakedAllocations)
+         + " memory leaks found.\n";
+}
+
+void writeJUnitReport(
+  std::ostream&                  os,
+  const std::vector<TestResult>& results,
+  double                         milliseconds)
+{
+  const auto failureCount{std::count_if(
+    results.begin(), results.end(), [](const TestResult& result) {
+      return !result.passed();
+    })};
+
+  os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+     << "<testsuite name=\"doubly_linked_list_app\" tests=\"" << results.size()
+     << "\" failures=\"" << failureCount << "\" time=\""
+     << milliseconds / 1000.0 << "\">\n";
+
+  for (const TestResult& result : results) {
+    os << "  <testcase classname=\"doubly_linked_list_app\" name=\""
+       << escapeXml(result.test->name) << "\" time=\""
+       << result.milliseconds / 1000.0 << '"';
+
+    if (result.passed()) {
+      os << "/>\n";
+      continue;
+    }
+
+    const std::string message{failureMessage(result)};
+    os << ">\n"
+       << "    <failure message=\""
+       << escapeXml(std::string_view{message}.substr(0, message.find('\n')))
+       << "\">"
+       << escapeXml(message) << "</failure>\n"
+       << "  </testcase>\n";
+  }
+
+  os << "</testsuite>\n";
+}
+
+void writeJsonReport(
+  std::ostream&                  os,
+  const std::vector<TestResult>& results,
+  double                         milliseconds)
+{
+  os << "{\n  \"milliseconds\": " << milliseconds << ",\n  \"tests\": [";
+
+  for (std::size_t i{0}; i < results.size(); ++i) {
+    const TestResult& result{results[i]};
+    os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \""
+       << escapeJson(result.test->name) << "\", \"passed\": "
+       << (result.passed() ? "true" : "false")
+       << ", \"milliseconds\": " << result.milliseconds
+       << ", \"leakedAllocations\": " << result.leakedAllocations
+       << ", \"failure\": \"" << escapeJson(result.failure) << "\"}";
   }
-  catch (const AssertionViolationException& ex) {
-    std::cerr << ex.what();
 
-    std::cerr << "\n\n\n";
-    std::cerr << ">>>>>>> TEST FAILURE!!!! <<<<\n";
+  os << "\n  ]\n}\n";
+}
+
+bool writeReport(
+  const std::string& path,
+  void (*write)(std::ostream&, const std::vector<TestResult>&, double),
+  const std::vector<TestResult>& results,
+  double                         milliseconds)
+{
+  std::ofstream file{path};
+  file.imbue(std::locale::classic());
+  file << std::fixed << std::setprecision(6);
+  write(file, results, milliseconds);
+  file.close();
+
+  if (!file) {
+    std::cerr << "Could not write the report " << path << ".\n";
+    return false;
+  }
+
+  return true;
+}
+
+void printUsage(const char* programName)
+{
+  std::cerr
+    << "Usage: " << programName << " [options]\n"
+    << "  --filter=GLOB  only run the test cases whose name matches GLOB;\n"
+    << "                 * matches any characters, ? a single one\n"
+    << "  --jobs=N       run up to N test cases concurrently\n"
+    << "  --junit=FILE   write a JUnit XML report to FILE\n"
+    << "  --json=FILE    write a JSON report to FILE\n";
+}
+
+int main(int argc, char* argv[])
+{
+  std::string_view filter{"*"};
+  std::size_t      jobCount{1};
+  std::string      junitPath{};
+  std::string      jsonPath{};
+
+  for (int i{1}; i < argc; ++i) {
+    const std::string_view argument{argv[i]};
+    const auto             optionValue{[argument](std::string_view option) {
+      return argument.substr(0, option.size()) == option
+               ? std::optional<std::string_view>{argument.substr(
+                 option.size())}
+               : std::nullopt;
+    }};
+
+    if (const auto value{optionValue("--filter=")}) { filter = *value; }
+    else if (const auto value{optionValue("--jobs=")}) {
+      jobCount = std::max<std::size_t>(
+        1, std::strtoull(std::string{*value}.c_str(), nullptr, 10));
+    }
+    else if (const auto value{optionValue("--junit=")}) {
+      junitPath = *value;
+    }
+    else if (const auto value{optionValue("--json=")}) {
+      jsonPath = *value;
+    }
+    else {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<const TestFunctionWithName*> tests{};
+
+  for (const TestFunctionWithName& test : testFunctions) {
+    if (matchesGlob(filter, test.name)) { tests.push_back(&test); }
+  }
+
+  const auto                    start{std::chrono::steady_clock::now()};
+  const std::vector<TestResult> results{runTests(tests, jobCount)};
+  const double                  milliseconds{
+    std::chrono::duration<double, std::milli>{
+      std::chrono::steady_clock::now() - start}
+      .count()};
+
+  int         exitStatus{EXIT_SUCCESS};
+  std::size_t failureCount{0};
+  std::cout.imbue(std::locale::classic());
+  std::cout << std::fixed << std::setprecision(3);
+
+  for (std::size_t i{0}; i < results.size(); ++i) {
+    const TestResult& result{results[i]};
+    std::cout << "Test case " << i + 1 << " \"" << result.test->name
+              << "\": " << (result.passed() ? "SUCCESS" : "FAILURE") << " ("
+              << result.milliseconds << " ms).\n";
+
+    if (!result.passed()) {
+      std::cerr << failureMessage(result) << '\n';
+      ++failureCount;
+    }
+  }
+
+  if (failureCount == 0) {
+    std::cout << ">>>> ALL " << results.size()
+              << " TESTS RAN SUCCESSFULLY in " << milliseconds << " ms\n";
+  }
+  else {
+    std::cerr << ">>>>>>> TEST FAILURE!!!! <<<< " << failureCount << " of "
+              << results.size() << " test cases failed.\n";
+    exitStatus |= EXIT_FAILURE;
+  }
 
+  if (!junitPath.empty()
+      && !writeReport(junitPath, &writeJUnitReport, results, milliseconds)) {
     exitStatus |= EXIT_FAILURE;
   }
 
-  std::vector<void*> leaks{};
+  if (!jsonPath.empty()
+      && !writeReport(jsonPath, &writeJsonReport, results, milliseconds)) {
+    exitStatus |= EXIT_FAILURE;
+  }
 
-  for (void* p : newed) {
-    auto it{deleted.find(p)};
+  // Allocations that no test case is responsible for, e.g. ones made by a
+  // thread that a test case didn't join.
+  std::vector<void*> leaks{};
 
-    if (it == deleted.end()) { leaks.push_back(p); }
+  for (const auto& [pointer, testRun] : liveAllocations) {
+    leaks.push_back(pointer);
   }
 
   std::sort(leaks.begin(), leaks.end());
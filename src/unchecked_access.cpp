@@ -0,0 +1,30 @@
+// Compiled to assembly by the unchecked_access_has_no_branches test, which
+// fails if any of the functions below contains a jump or a call: with
+// ListAccess::unchecked, front and back have to be plain pointer loads.
+#include "list.hpp"
+
+using UncheckedList = List<long, ListConfig{.access = ListAccess::unchecked}>;
+
+using UncheckedUntrackedList = List<
+  long,
+  ListConfig{.access = ListAccess::unchecked, .tracksSize = false}>;
+
+extern "C" long uncheckedFront(const UncheckedList& list)
+{
+  return list.front();
+}
+
+extern "C" long uncheckedBack(const UncheckedList& list)
+{
+  return list.back();
+}
+
+extern "C" void uncheckedAssignFront(UncheckedList& list, long value)
+{
+  list.front() = value;
+}
+
+extern "C" long uncheckedUntrackedBack(const UncheckedUntrackedList& list)
+{
+  return list.back();
+}